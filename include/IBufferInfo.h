@@ -1,6 +1,6 @@
 /*
  * (C) 2003-2006 Gabest
- * (C) 2006-2014 see Authors.txt
+ * (C) 2006-2023 see Authors.txt
  *
  * This file is part of MPC-BE.
  *
@@ -28,3 +28,12 @@ public IUnknown {
 	STDMETHOD(GetStatus(int i, int& samples, int& size)) PURE;
 	STDMETHOD_(DWORD, GetPriority()) PURE;
 };
+
+// IBufferInfo is also implemented by other splitters, new methods go here
+interface __declspec(uuid("7DA68ED4-EF6C-409B-9661-DC51571366FC"))
+IBufferInfo2 :
+public IBufferInfo {
+	// disk cache of a remote source: chunks read from the cache, chunks downloaded, bytes read from the cache
+	// returns S_FALSE if the source does not use the cache
+	STDMETHOD(GetCacheStatus(UINT64& hits, UINT64& misses, UINT64& bytes)) PURE;
+};
@@ -1,6 +1,6 @@
 /*
  * (C) 2003-2006 Gabest
- * (C) 2006-2014 see Authors.txt
+ * (C) 2006-2023 see Authors.txt
  *
  * This file is part of MPC-BE.
  *
@@ -33,5 +33,6 @@ enum dsmp_t {
 	DSMP_CHAPTERS		= 3,
 	DSMP_SAMPLE			= 4,
 	DSMP_SYNCPOINTS		= 5,
-	DSMP_RESOURCE		= 6
+	DSMP_RESOURCE		= 6,
+	DSMP_SYNCPOINTS_PART	= 7  // written while muxing, the syncpoints since the previous one and the distance back to it
 };
@@ -540,6 +540,54 @@ HRESULT convert_to_float(const SampleFormat sfmt, const WORD nChannels, const DW
 	return S_OK;
 }
 
+void interleave_planar_float(float* pOut, const float* const* planes, const WORD nChannels, const DWORD nSamples)
+{
+	DWORD i = 0;
+
+	if (nChannels == 2) {
+		const float* pL = planes[0];
+		const float* pR = planes[1];
+		for (; i + 4 <= nSamples; i += 4) {
+			const __m128 l = _mm_loadu_ps(pL + i);
+			const __m128 r = _mm_loadu_ps(pR + i);
+			_mm_storeu_ps(pOut,     _mm_unpacklo_ps(l, r));
+			_mm_storeu_ps(pOut + 4, _mm_unpackhi_ps(l, r));
+			pOut += 8;
+		}
+	}
+	else if (nChannels >= 4) {
+		// four samples of four channels per transpose, the remaining channels are copied one by one
+		for (; i + 4 <= nSamples; i += 4) {
+			WORD ch = 0;
+			for (; ch + 4 <= nChannels; ch += 4) {
+				__m128 r0 = _mm_loadu_ps(planes[ch + 0] + i);
+				__m128 r1 = _mm_loadu_ps(planes[ch + 1] + i);
+				__m128 r2 = _mm_loadu_ps(planes[ch + 2] + i);
+				__m128 r3 = _mm_loadu_ps(planes[ch + 3] + i);
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+				_mm_storeu_ps(pOut + ch,                 r0);
+				_mm_storeu_ps(pOut + ch + nChannels,     r1);
+				_mm_storeu_ps(pOut + ch + nChannels * 2, r2);
+				_mm_storeu_ps(pOut + ch + nChannels * 3, r3);
+			}
+			for (; ch < nChannels; ch++) {
+				const float* p = planes[ch] + i;
+				pOut[ch]                 = p[0];
+				pOut[ch + nChannels]     = p[1];
+				pOut[ch + nChannels * 2] = p[2];
+				pOut[ch + nChannels * 3] = p[3];
+			}
+			pOut += nChannels * 4;
+		}
+	}
+
+	for (; i < nSamples; i++) {
+		for (WORD ch = 0; ch < nChannels; ch++) {
+			*pOut++ = planes[ch][i];
+		}
+	}
+}
+
 HRESULT convert_to_planar_float(const SampleFormat sfmt, const WORD nChannels, const DWORD nSamples, BYTE* pIn, float* pOut)
 {
 	size_t allsamples = nSamples * nChannels;
@@ -97,6 +97,8 @@ HRESULT convert_to_int24(const SampleFormat sfmt, const WORD nChannels, const DW
 HRESULT convert_to_int32(const SampleFormat sfmt, const WORD nChannels, const DWORD nSamples, BYTE* pIn, int32_t* pOut);
 HRESULT convert_to_float(const SampleFormat sfmt, const WORD nChannels, const DWORD nSamples, BYTE* pIn, float* pOut);
 
+void interleave_planar_float(float* pOut, const float* const* planes, const WORD nChannels, const DWORD nSamples);
+
 HRESULT convert_to_planar_float(const SampleFormat sfmt, const WORD nChannels, const DWORD nSamples, BYTE* pIn, float* pOut);
 
 HRESULT convert_float_to(const SampleFormat sfmt, const WORD nChannels, const DWORD nSamples, float* pIn, BYTE* pOut);
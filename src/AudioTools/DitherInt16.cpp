@@ -19,6 +19,7 @@
  */
 
 #include "stdafx.h"
+#include <emmintrin.h>
 #include "AudioHelper.h"
 #include "DSUtil/SimpleBuffer.h"
 #include "DitherInt16.h"
@@ -30,10 +31,7 @@
 
 CDitherInt16::CDitherInt16()
 {
-	for (auto& distributor : m_distributor) {
-		// unnecessary initialization with the range (0; 1). it's here to just show the range explicitly.
-		distributor = std::uniform_real_distribution<float>(0.0f, 1.0f);
-	}
+	Initialize();
 }
 
 void CDitherInt16::Initialize()
@@ -41,12 +39,35 @@ void CDitherInt16::Initialize()
 	m_simpleBuffer.SetSize(0);
 
 	m_previous.fill(0.0f);
-	unsigned seed = 12345;
-	for (auto& generator : m_generator) {
-		generator.seed(seed++);
+	m_error1.fill(0.0f);
+	m_error2.fill(0.0f);
+
+	uint32_t seed = 12345;
+	for (auto& state : m_state) {
+		state = seed++;
 	}
 }
 
+void CDitherInt16::GenerateRandom(float* pDst, const int count)
+{
+	// writes up to three values past count
+	__m128i x = _mm_loadu_si128((const __m128i*)m_state);
+	const __m128i exponent = _mm_set1_epi32(0x3f800000);
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	for (int i = 0; i < count; i += 4) {
+		x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+		x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+		x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+
+		// 23 random bits as the mantissa of a float in [1; 2)
+		const __m128 r = _mm_castsi128_ps(_mm_or_si128(_mm_srli_epi32(x, 9), exponent));
+		_mm_storeu_ps(pDst + i, _mm_sub_ps(r, one));
+	}
+
+	_mm_storeu_si128((__m128i*)m_state, x);
+}
+
 void CDitherInt16::UpdateInput(const SampleFormat sf, const int chanels)
 {
 	if (sf != m_sf || chanels != m_chanels) {
@@ -57,22 +78,58 @@ void CDitherInt16::UpdateInput(const SampleFormat sf, const int chanels)
 	}
 }
 
+void CDitherInt16::SetNoiseShaping(const bool bNoiseShaping)
+{
+	if (bNoiseShaping != m_bNoiseShaping) {
+		m_bNoiseShaping = bNoiseShaping;
+		m_error1.fill(0.0f);
+		m_error2.fill(0.0f);
+	}
+}
+
 void CDitherInt16::ProcessFloat(int16_t* pDst, float* pSrc, const int samples)
 {
-	for (int frame = 0; frame < samples; frame++) {
-		for (int channel = 0; channel < m_chanels; channel++) {
-			float inputSample = pSrc[frame * m_chanels + channel] * (INT16_MAX - 1);
-
-			// High-pass TPDF, 2 LSB amplitude.
-			float r = m_distributor[channel](m_generator[channel]);
-			float noise = r - m_previous[channel];
-			m_previous[channel] = r;
-
-			float outputSample = std::round(inputSample + noise);
-			ASSERT(outputSample >= INT16_MIN && outputSample <= INT16_MAX);
-			pDst[frame * m_chanels + channel] = (int16_t)outputSample;
+	const int count = samples * m_chanels;
+
+	m_random.ExpandSize(m_chanels + count + 3);
+	float* random = m_random.Data();
+	memcpy(random, m_previous.data(), m_chanels * sizeof(float));
+	GenerateRandom(random + m_chanels, count);
+
+	// High-pass TPDF, 2 LSB amplitude: the noise of a sample is its random value
+	// minus the random value of the same channel in the previous frame.
+	const float* noise_add = random + m_chanels;
+	const float* noise_sub = random;
+
+	if (m_bNoiseShaping) {
+		// second order error feedback, the noise transfer function (1 - 0.8z^-1)^2
+		// moves the noise away from the low and middle frequencies
+		for (int frame = 0, i = 0; frame < samples; frame++) {
+			for (int channel = 0; channel < m_chanels; channel++, i++) {
+				const float inputSample = pSrc[i] * (INT16_MAX - 1) - 1.6f * m_error1[channel] + 0.64f * m_error2[channel];
+				const int outputSample = _mm_cvtss_si32(_mm_set_ss(inputSample + noise_add[i] - noise_sub[i]));
+
+				m_error2[channel] = m_error1[channel];
+				m_error1[channel] = outputSample - inputSample;
+				pDst[i] = (int16_t)std::clamp(outputSample, INT16_MIN, INT16_MAX);
+			}
+		}
+	} else {
+		const __m128 scale = _mm_set1_ps(INT16_MAX - 1);
+
+		int i = 0;
+		for (; i + 8 <= count; i += 8) {
+			const __m128 a = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(pSrc + i), scale), _mm_sub_ps(_mm_loadu_ps(noise_add + i), _mm_loadu_ps(noise_sub + i)));
+			const __m128 b = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(pSrc + i + 4), scale), _mm_sub_ps(_mm_loadu_ps(noise_add + i + 4), _mm_loadu_ps(noise_sub + i + 4)));
+			_mm_storeu_si128((__m128i*)(pDst + i), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+		}
+		for (; i < count; i++) {
+			const int outputSample = _mm_cvtss_si32(_mm_set_ss(pSrc[i] * (INT16_MAX - 1) + noise_add[i] - noise_sub[i]));
+			pDst[i] = (int16_t)std::clamp(outputSample, INT16_MIN, INT16_MAX);
 		}
 	}
+
+	memcpy(m_previous.data(), random + count, m_chanels * sizeof(float));
 }
 
 void CDitherInt16::Process(int16_t* pDst, BYTE* pSrc, const int samples)
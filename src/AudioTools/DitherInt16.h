@@ -21,7 +21,6 @@
 #pragma once
 
 #include <array>
-#include <random>
 
 // converts to Int16 with dither if necessary
 class CDitherInt16
@@ -29,18 +28,28 @@ class CDitherInt16
 	SampleFormat m_sf      = SAMPLE_FMT_NONE;
 	uint32_t     m_layout  = 0;
 	int          m_chanels = 0;
+	bool         m_bNoiseShaping = false;
 
 	CSimpleBuffer<float> m_simpleBuffer;
 
+	// uniform random values in [0; 1), the first m_chanels values are from the previous frame
+	CSimpleBuffer<float> m_random;
 	std::array<float, 18> m_previous;
-	std::array<std::minstd_rand, 18> m_generator;
-	std::array<std::uniform_real_distribution<float>, 18> m_distributor;
+
+	// four xorshift32 generators
+	uint32_t m_state[4];
+
+	// quantization errors of the last two frames for noise shaping
+	std::array<float, 18> m_error1;
+	std::array<float, 18> m_error2;
 
 	void Initialize();
+	void GenerateRandom(float* pDst, const int count);
 
 public:
 	CDitherInt16();
 	void UpdateInput(const SampleFormat sf, const int chanels);
+	void SetNoiseShaping(const bool bNoiseShaping);
 
 	void ProcessFloat(int16_t* pDst, float* pSrc, const int samples);
 	void Process(int16_t* pDst, BYTE* pSrc, const int samples);
@@ -20,6 +20,7 @@
 
 #include "stdafx.h"
 #include "math.h"
+#include <emmintrin.h>
 #include "AudioTools.h"
 
 #define INT8_PEAK       128
@@ -82,6 +83,20 @@ void gain_int32(const double factor, const size_t allsamples, int32_t* pData)
 void gain_float(const double factor, const size_t allsamples, float* pData)
 {
     float* end = pData + allsamples;
+
+    // same double precision math as below, four samples at a time
+    const __m128d f   = _mm_set1_pd(factor);
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d neg = _mm_set1_pd(-1.0);
+    for (; pData + 4 <= end; pData += 4) {
+        const __m128 s = _mm_loadu_ps(pData);
+        __m128d lo = _mm_mul_pd(_mm_cvtps_pd(s), f);
+        __m128d hi = _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(s, s)), f);
+        lo = _mm_min_pd(one, _mm_max_pd(neg, lo));
+        hi = _mm_min_pd(one, _mm_max_pd(neg, hi));
+        _mm_storeu_ps(pData, _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi)));
+    }
+
     for (; pData < end; ++pData) {
         double d = factor * (*pData);
         limit(-1.0, d, 1.0);
@@ -175,12 +175,14 @@ void CHTTPAsync::Close()
 	m_url_str.Empty();
 	m_host.Empty();
 	m_path.Empty();
+	m_customHeader.Empty();
 
 	m_nPort   = 0;
 	m_nScheme = INTERNET_SCHEME_HTTP;
 
 	m_header.Empty();
 	m_contentType.Empty();
+	m_validator.Empty();
 	m_lenght = 0;
 
 	m_bRequestComplete = TRUE;
@@ -199,6 +201,7 @@ HRESULT CHTTPAsync::Connect(LPCWSTR lpszURL, DWORD dwTimeOut/* = INFINITE*/, LPC
 	}
 
 	m_url_str = lpszURL;
+	m_customHeader = lpszCustomHeader;
 	m_host    = urlParser.GetHostName();
 	m_path    = CString(urlParser.GetUrlPath()) + CString(urlParser.GetExtraInfo());
 	m_nPort   = urlParser.GetPortNumber();
@@ -266,6 +269,11 @@ HRESULT CHTTPAsync::Connect(LPCWSTR lpszURL, DWORD dwTimeOut/* = INFINITE*/, LPC
 	m_contentEncoding = QueryInfoStr(HTTP_QUERY_CONTENT_ENCODING).MakeLower();
 	m_bSupportsRanges = QueryInfoStr(HTTP_QUERY_ACCEPT_RANGES).MakeLower() == L"bytes";
 
+	m_validator = QueryInfoStr(HTTP_QUERY_ETAG);
+	if (m_validator.IsEmpty()) {
+		m_validator = QueryInfoStr(HTTP_QUERY_LAST_MODIFIED);
+	}
+
 	m_bIsCompressed = !m_contentEncoding.IsEmpty() && (StartsWith(m_contentEncoding, L"gzip") || StartsWith(m_contentEncoding, L"deflate"));
 
 	const CString queryInfo = QueryInfoStr(HTTP_QUERY_CONTENT_LENGTH);
@@ -466,18 +474,26 @@ HRESULT CHTTPAsync::SeekInternal(UINT64 position)
 	return SendRequest(customHeader);
 }
 
-HRESULT CHTTPAsync::RangeInternal(UINT64 start, UINT64 end)
+HRESULT CHTTPAsync::RangeInternal(UINT64 start, UINT64 end, DWORD dwTimeOut/* = INFINITE*/)
 {
-	if (start >= end) {
+	// the end is inclusive, a range of one byte has start == end
+	if (start > end) {
 		return E_FAIL;
 	}
 
-	if (!m_lenght || end > m_lenght) {
+	if (!m_lenght || end >= m_lenght) {
 		return E_FAIL;
 	}
 
-	CString customHeader; customHeader.Format(L"Range: bytes=%I64u-%I64u\r\n", start, end);
-	return SendRequest(customHeader);
+	CString customHeader; customHeader.Format(L"%sRange: bytes=%I64u-%I64u\r\n", m_customHeader.GetString(), start, end);
+	HRESULT hr = SendRequest(customHeader, dwTimeOut);
+	if (hr == S_OK && QueryInfoDword(HTTP_QUERY_STATUS_CODE) != HTTP_STATUS_PARTIAL_CONTENT) {
+		// the server ignored the range and sends the whole file from the beginning
+		DLog(L"CHTTPAsync::RangeInternal() : no partial content for bytes %I64u-%I64u", start, end);
+		hr = E_FAIL;
+	}
+
+	return hr;
 }
 
 HRESULT CHTTPAsync::Seek(UINT64 position)
@@ -493,6 +509,11 @@ HRESULT CHTTPAsync::Seek(UINT64 position)
 	}
 }
 
+HRESULT CHTTPAsync::Range(UINT64 start, UINT64 end, DWORD dwTimeOut/* = INFINITE*/)
+{
+	return RangeInternal(start, end, dwTimeOut);
+}
+
 constexpr size_t decompressBlockSize = 1024;
 bool CHTTPAsync::GetUncompressed(std::vector<BYTE>& buffer)
 {
@@ -558,6 +579,16 @@ const CString& CHTTPAsync::GetContentEncoding() const
 	return m_contentEncoding;
 }
 
+const CString& CHTTPAsync::GetValidator() const
+{
+	return m_validator;
+}
+
+const CString& CHTTPAsync::GetCustomHeader() const
+{
+	return m_customHeader;
+}
+
 const bool CHTTPAsync::IsSupportsRanges() const
 {
 	return m_bSupportsRanges;
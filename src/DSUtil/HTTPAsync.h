@@ -55,6 +55,7 @@ protected:
 	CString m_path;
 
 	CString m_url_redirect_str;
+	CString m_customHeader;
 
 	INTERNET_PORT m_nPort     = 0;
 	INTERNET_SCHEME m_nScheme = INTERNET_SCHEME_HTTP;
@@ -62,6 +63,7 @@ protected:
 	CString m_header;
 	CString m_contentType;
 	CString m_contentEncoding;
+	CString m_validator;
 	UINT64 m_lenght = 0;
 
 	bool m_bIsCompressed = false;
@@ -88,7 +90,7 @@ protected:
 	DWORD QueryInfoDword(DWORD dwInfoLevel) const;
 
 	HRESULT SeekInternal(UINT64 position);
-	HRESULT RangeInternal(UINT64 start, UINT64 end);
+	HRESULT RangeInternal(UINT64 start, UINT64 end, DWORD dwTimeOut = INFINITE);
 
 	HRESULT ReadInternal(PBYTE pBuffer, DWORD dwSizeToRead, DWORD& dwSizeRead, DWORD dwTimeOut);
 
@@ -103,6 +105,8 @@ public:
 	HRESULT Read(PBYTE pBuffer, DWORD dwSizeToRead, DWORD& dwSizeRead, DWORD dwTimeOut = INFINITE);
 
 	HRESULT Seek(UINT64 position);
+	// request the bytes from start to end inclusive, fails if the server does not return a partial content
+	HRESULT Range(UINT64 start, UINT64 end, DWORD dwTimeOut = INFINITE);
 
 	const CString& GetHeader() const;
 
@@ -111,6 +115,12 @@ public:
 	// get content encoding in lowercase
 	const CString& GetContentEncoding() const;
 
+	// get ETag or Last-Modified value, empty if the server does not send them
+	const CString& GetValidator() const;
+
+	// the custom header passed to Connect(), it is also sent with the range requests
+	const CString& GetCustomHeader() const;
+
 	const bool IsSupportsRanges() const;
 	const bool IsGoogleMedia() const;
 
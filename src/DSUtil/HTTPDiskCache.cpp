@@ -0,0 +1,204 @@
+/*
+ * (C) 2023 see Authors.txt
+ *
+ * This file is part of MPC-BE.
+ *
+ * MPC-BE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MPC-BE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "stdafx.h"
+#include "HTTPDiskCache.h"
+#include "Log.h"
+
+static UINT64 FileTimeToUINT64(const FILETIME& ft)
+{
+	return ((UINT64)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+}
+
+static UINT64 GetCurrentFileTime()
+{
+	FILETIME ft;
+	GetSystemTimeAsFileTime(&ft);
+	return FileTimeToUINT64(ft);
+}
+
+CHTTPDiskCache& CHTTPDiskCache::Instance()
+{
+	static CHTTPDiskCache cache;
+	return cache;
+}
+
+CStringW CHTTPDiskCache::MakeKey(LPCWSTR lpszURL, LPCWSTR lpszValidator)
+{
+	// 64-bit FNV-1a
+	UINT64 hash = 0xcbf29ce484222325ull;
+	auto Hash = [&hash](LPCWSTR str) {
+		for (; *str; str++) {
+			hash = (hash ^ (UINT64)*str) * 0x100000001b3ull;
+		}
+	};
+	Hash(lpszURL);
+	Hash(L"\n");
+	Hash(lpszValidator);
+
+	CStringW key;
+	key.Format(L"%016I64x", hash);
+	return key;
+}
+
+CStringW CHTTPDiskCache::FileName(const CStringW& key, const UINT64 index) const
+{
+	CStringW name;
+	name.Format(L"%s_%08I64x.chunk", key.GetString(), index);
+	return name;
+}
+
+bool CHTTPDiskCache::Init()
+{
+	if (m_bInitialized) {
+		return !m_path.IsEmpty();
+	}
+	m_bInitialized = true;
+
+	WCHAR lpszTempPath[MAX_PATH] = {};
+	if (!GetTempPathW(MAX_PATH, lpszTempPath)) {
+		return false;
+	}
+
+	CStringW path(lpszTempPath);
+	path.Append(L"mpc-be_http_cache\\");
+	if (!CreateDirectoryW(path, nullptr) && GetLastError() != ERROR_ALREADY_EXISTS) {
+		DLog(L"CHTTPDiskCache::Init() : can't create '%s'", path.GetString());
+		return false;
+	}
+
+	WIN32_FIND_DATAW fd;
+	HANDLE hFind = FindFirstFileW(path + L"*.*", &fd);
+	if (hFind != INVALID_HANDLE_VALUE) {
+		do {
+			if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+				continue;
+			}
+
+			const CStringW name(fd.cFileName);
+			if (name.Right(6) == L".chunk") {
+				const UINT64 size = ((UINT64)fd.nFileSizeHigh << 32) | fd.nFileSizeLow;
+				m_files[name] = { size, FileTimeToUINT64(fd.ftLastWriteTime) };
+				m_size += size;
+			} else {
+				// unfinished file
+				DeleteFileW(path + name);
+			}
+		} while (FindNextFileW(hFind, &fd));
+		FindClose(hFind);
+	}
+
+	m_path = path;
+	Evict(0);
+
+	return true;
+}
+
+void CHTTPDiskCache::Evict(const UINT64 size)
+{
+	while (m_size + size > maximum_size && !m_files.empty()) {
+		auto lru = m_files.begin();
+		for (auto it = m_files.begin(); it != m_files.end(); ++it) {
+			if (it->second.lastuse < lru->second.lastuse) {
+				lru = it;
+			}
+		}
+
+		DeleteFileW(m_path + lru->first);
+		m_size -= lru->second.size;
+		m_files.erase(lru);
+	}
+}
+
+bool CHTTPDiskCache::Read(const CStringW& key, const UINT64 index, std::vector<BYTE>& data, const DWORD size)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	if (!Init()) {
+		return false;
+	}
+
+	const CStringW name = FileName(key, index);
+	auto it = m_files.find(name);
+	if (it == m_files.end()) {
+		return false;
+	}
+
+	bool bRead = false;
+	if (it->second.size == size) {
+		HANDLE hFile = CreateFileW(m_path + name, GENERIC_READ | FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (hFile != INVALID_HANDLE_VALUE) {
+			data.resize(size);
+			DWORD dwSizeRead = 0;
+			if (ReadFile(hFile, data.data(), size, &dwSizeRead, nullptr) && dwSizeRead == size) {
+				// the write time keeps the LRU order between sessions
+				FILETIME ft;
+				GetSystemTimeAsFileTime(&ft);
+				SetFileTime(hFile, nullptr, nullptr, &ft);
+				it->second.lastuse = FileTimeToUINT64(ft);
+				bRead = true;
+			}
+			CloseHandle(hFile);
+		}
+	}
+
+	if (!bRead) {
+		DeleteFileW(m_path + name);
+		m_size -= it->second.size;
+		m_files.erase(it);
+	}
+
+	return bRead;
+}
+
+void CHTTPDiskCache::Write(const CStringW& key, const UINT64 index, const std::vector<BYTE>& data)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	if (!Init() || data.size() > maximum_size) {
+		return;
+	}
+
+	const CStringW name = FileName(key, index);
+	if (m_files.find(name) != m_files.end()) {
+		return;
+	}
+
+	Evict(data.size());
+
+	// write to a temporary name first, so a crash never leaves a truncated chunk
+	const CStringW tmpname = m_path + name + L".tmp";
+	HANDLE hFile = CreateFileW(tmpname, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		return;
+	}
+
+	DWORD dwSizeWritten = 0;
+	const BOOL bWritten = WriteFile(hFile, data.data(), (DWORD)data.size(), &dwSizeWritten, nullptr) && dwSizeWritten == data.size();
+	CloseHandle(hFile);
+
+	if (!bWritten || !MoveFileExW(tmpname, m_path + name, MOVEFILE_REPLACE_EXISTING)) {
+		DeleteFileW(tmpname);
+		return;
+	}
+
+	m_files[name] = { data.size(), GetCurrentFileTime() };
+	m_size += data.size();
+}
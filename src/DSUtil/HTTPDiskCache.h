@@ -0,0 +1,62 @@
+/*
+ * (C) 2023 see Authors.txt
+ *
+ * This file is part of MPC-BE.
+ *
+ * MPC-BE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MPC-BE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include "mpc_defines.h"
+
+// Chunks of remote files stored in the temporary folder.
+// A chunk file is named after a hash of the URL and the ETag/Last-Modified
+// value, so a changed file on the server never matches old chunks.
+// The least recently used files are deleted when the size limit is reached.
+
+class CHTTPDiskCache
+{
+public:
+	constexpr static UINT64 maximum_size = 512ull * MEGABYTE;
+
+private:
+	struct file_t {
+		UINT64 size;
+		UINT64 lastuse; // FILETIME
+	};
+
+	std::mutex m_mutex;
+	CStringW m_path;
+	std::map<CStringW, file_t> m_files;
+	UINT64 m_size = 0;
+	bool m_bInitialized = false;
+
+	CHTTPDiskCache() = default;
+
+	bool Init();
+	void Evict(const UINT64 size);
+	CStringW FileName(const CStringW& key, const UINT64 index) const;
+
+public:
+	static CHTTPDiskCache& Instance();
+
+	static CStringW MakeKey(LPCWSTR lpszURL, LPCWSTR lpszValidator);
+
+	bool Read(const CStringW& key, const UINT64 index, std::vector<BYTE>& data, const DWORD size);
+	void Write(const CStringW& key, const UINT64 index, const std::vector<BYTE>& data);
+};
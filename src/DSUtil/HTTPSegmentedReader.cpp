@@ -0,0 +1,273 @@
+/*
+ * (C) 2023 see Authors.txt
+ *
+ * This file is part of MPC-BE.
+ *
+ * MPC-BE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MPC-BE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "stdafx.h"
+#include "HTTPSegmentedReader.h"
+#include "HTTPAsync.h"
+#include "HTTPDiskCache.h"
+#include "Log.h"
+
+CHTTPSegmentedReader::CHTTPSegmentedReader(LPCWSTR lpszURL, const UINT64 lenght, LPCWSTR lpszValidator, LPCWSTR lpszCustomHeader/* = L""*/)
+	: m_url(lpszURL)
+	, m_customHeader(lpszCustomHeader)
+	, m_lenght(lenght)
+{
+	if (lpszValidator && *lpszValidator) {
+		m_cachekey = CHTTPDiskCache::MakeKey(lpszURL, lpszValidator);
+	}
+
+	for (size_t i = 0; i < connections; i++) {
+		m_threads.emplace_back(&CHTTPSegmentedReader::ThreadWorker, this);
+	}
+}
+
+CHTTPSegmentedReader::~CHTTPSegmentedReader()
+{
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_bStop = true;
+	}
+	m_cvWork.notify_all();
+	m_cvReady.notify_all();
+
+	for (auto& thread : m_threads) {
+		if (thread.joinable()) {
+			thread.join();
+		}
+	}
+
+	DLog(L"CHTTPSegmentedReader::~CHTTPSegmentedReader() : %I64u range requests, %I64u bytes downloaded, %I64u chunks (%I64u bytes) from the disk cache, %I64u seeks, %I64u waits for data",
+		 m_nRequests, m_downloaded, m_nCacheHits, m_cachedBytes, m_nSeeks, m_nWaits);
+}
+
+DWORD CHTTPSegmentedReader::ChunkSize(const UINT64 index) const
+{
+	return (DWORD)std::min(chunk_size, m_lenght - index * chunk_size);
+}
+
+void CHTTPSegmentedReader::Request(const UINT64 index, const bool bUrgent)
+{
+	if (index * chunk_size >= m_lenght) {
+		return;
+	}
+
+	auto it = m_chunks.find(index);
+	if (it != m_chunks.end() && it->second.state == ChunkState::failed) {
+		// try it once more
+		m_chunks.erase(it);
+		it = m_chunks.end();
+	}
+
+	if (it == m_chunks.end()) {
+		m_chunks.emplace(index, chunk_t());
+		if (bUrgent) {
+			m_queue.emplace_front(index);
+		} else {
+			m_queue.emplace_back(index);
+		}
+	} else if (bUrgent && it->second.state == ChunkState::queued) {
+		// move it to the front of the queue
+		m_queue.erase(std::find(m_queue.begin(), m_queue.end(), index));
+		m_queue.emplace_front(index);
+	}
+}
+
+void CHTTPSegmentedReader::DropQueued()
+{
+	for (const auto& index : m_queue) {
+		m_chunks.erase(index);
+	}
+	m_queue.clear();
+}
+
+void CHTTPSegmentedReader::EvictChunks()
+{
+	size_t count = 0;
+	for (const auto& [index, chunk] : m_chunks) {
+		if (chunk.state == ChunkState::ready) {
+			count++;
+		}
+	}
+
+	while (count > cached_chunks) {
+		auto lru = m_chunks.end();
+		for (auto it = m_chunks.begin(); it != m_chunks.end(); ++it) {
+			if (it->second.state == ChunkState::ready
+					&& (lru == m_chunks.end() || it->second.lastuse < lru->second.lastuse)) {
+				lru = it;
+			}
+		}
+		m_chunks.erase(lru);
+		count--;
+	}
+}
+
+void CHTTPSegmentedReader::ThreadWorker()
+{
+	CHTTPAsync http;
+	bool bConnected = false;
+	std::vector<BYTE> buffer;
+
+	for (;;) {
+		UINT64 index;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_cvWork.wait(lock, [&] { return m_bStop || !m_queue.empty(); });
+			if (m_bStop) {
+				break;
+			}
+
+			index = m_queue.front();
+			m_queue.pop_front();
+			m_chunks[index].state = ChunkState::loading;
+		}
+
+		const UINT64 start = index * chunk_size;
+		const DWORD size = ChunkSize(index);
+		buffer.resize(size);
+
+		HRESULT hr = E_FAIL;
+		bool bCached = false;
+		if (m_cachekey.GetLength() && CHTTPDiskCache::Instance().Read(m_cachekey, index, buffer, size)) {
+			hr = S_OK;
+			bCached = true;
+		}
+
+		for (int attempt = 0; attempt < 2 && hr != S_OK; attempt++) {
+			if (!bConnected) {
+				bConnected = (http.Connect(m_url, timeout, m_customHeader) == S_OK);
+			}
+			if (bConnected && http.Range(start, start + size - 1, timeout) == S_OK) {
+				DWORD dwSizeRead = 0;
+				hr = http.Read(buffer.data(), size, dwSizeRead, timeout);
+				if (hr == S_OK && dwSizeRead != size) {
+					hr = E_FAIL;
+				}
+			}
+			if (hr != S_OK) {
+				bConnected = false;
+			}
+		}
+
+		if (hr == S_OK && !bCached && m_cachekey.GetLength()) {
+			CHTTPDiskCache::Instance().Write(m_cachekey, index, buffer);
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			if (bCached) {
+				m_nCacheHits++;
+				m_cachedBytes += size;
+			} else {
+				m_nRequests++;
+			}
+
+			auto it = m_chunks.find(index);
+			if (it != m_chunks.end()) {
+				if (hr == S_OK) {
+					it->second.data.swap(buffer);
+					it->second.state = ChunkState::ready;
+					it->second.lastuse = ++m_tick;
+					if (!bCached) {
+						m_downloaded += size;
+					}
+					EvictChunks();
+				} else {
+					DLog(L"CHTTPSegmentedReader::ThreadWorker() : failed to read the range %I64u-%I64u", start, start + size - 1);
+					it->second.state = ChunkState::failed;
+				}
+			}
+		}
+		m_cvReady.notify_all();
+	}
+}
+
+HRESULT CHTTPSegmentedReader::Read(const UINT64 position, BYTE* pBuffer, const DWORD dwSizeToRead)
+{
+	if (!dwSizeToRead) {
+		return S_OK;
+	}
+	if (position + dwSizeToRead > m_lenght) {
+		return E_FAIL;
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	const UINT64 first = position / chunk_size;
+	const UINT64 last  = (position + dwSizeToRead - 1) / chunk_size;
+
+	if (m_lastIndex != UINT64_MAX && first != m_lastIndex && first != m_lastIndex + 1) {
+		// seeking, the queued prefetch is not needed anymore
+		m_nSeeks++;
+		DropQueued();
+	}
+
+	for (UINT64 index = last + 1; index >= first + 1; index--) {
+		Request(index - 1, true);
+	}
+	for (UINT64 index = last + 1; index <= last + prefetch; index++) {
+		Request(index, false);
+	}
+	m_cvWork.notify_all();
+
+	UINT64 pos = position;
+	DWORD dwSizeRead = 0;
+	for (UINT64 index = first; index <= last; index++) {
+		auto it = m_chunks.find(index);
+		if (it == m_chunks.end() || it->second.state != ChunkState::ready) {
+			m_nWaits++;
+			m_cvReady.wait(lock, [&] {
+				it = m_chunks.find(index);
+				if (it == m_chunks.end()) {
+					// dropped by a seek from another thread
+					Request(index, true);
+					m_cvWork.notify_one();
+					return m_bStop;
+				}
+				return m_bStop || it->second.state == ChunkState::ready || it->second.state == ChunkState::failed;
+			});
+			if (m_bStop || it == m_chunks.end() || it->second.state != ChunkState::ready) {
+				return E_FAIL;
+			}
+		}
+
+		auto& chunk = it->second;
+		const DWORD offset = (DWORD)(pos - index * chunk_size);
+		const DWORD size = std::min<DWORD>(dwSizeToRead - dwSizeRead, (DWORD)chunk.data.size() - offset);
+		memcpy(pBuffer + dwSizeRead, chunk.data.data() + offset, size);
+		chunk.lastuse = ++m_tick;
+
+		dwSizeRead += size;
+		pos += size;
+	}
+
+	m_lastIndex = last;
+
+	return S_OK;
+}
+
+void CHTTPSegmentedReader::GetCacheStatus(UINT64& hits, UINT64& misses, UINT64& bytes)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	hits   = m_nCacheHits;
+	misses = m_nRequests;
+	bytes  = m_cachedBytes;
+}
@@ -0,0 +1,100 @@
+/*
+ * (C) 2023 see Authors.txt
+ *
+ * This file is part of MPC-BE.
+ *
+ * MPC-BE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MPC-BE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <map>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "mpc_defines.h"
+
+// Reads a remote file through several parallel range requests.
+// The file is split into fixed size chunks, the chunks are downloaded by a pool
+// of connections into a small memory cache, and the chunks after the last read
+// are prefetched. A seek drops the prefetch requests that have not started yet.
+// If the server sends a validator, the chunks are also kept in CHTTPDiskCache
+// and read from there before a range request is made.
+
+class CHTTPSegmentedReader
+{
+public:
+	constexpr static UINT64 chunk_size    = 1 * MEGABYTE;
+	constexpr static size_t connections   = 4;
+	constexpr static size_t prefetch      = 8;  // chunks requested ahead of the last read
+	constexpr static size_t cached_chunks = 32; // completed chunks kept in memory
+	constexpr static DWORD  timeout       = 10000;
+
+private:
+	enum class ChunkState {
+		queued,
+		loading,
+		ready,
+		failed
+	};
+
+	struct chunk_t {
+		ChunkState state = ChunkState::queued;
+		std::vector<BYTE> data;
+		UINT64 lastuse = 0;
+	};
+
+	CString m_url;
+	CString m_customHeader;
+	UINT64 m_lenght = 0;
+	CStringW m_cachekey;
+
+	std::mutex m_mutex;
+	std::condition_variable m_cvWork;
+	std::condition_variable m_cvReady;
+
+	std::map<UINT64, chunk_t> m_chunks;
+	std::deque<UINT64> m_queue;
+	UINT64 m_tick      = 0;
+	UINT64 m_lastIndex = UINT64_MAX;
+	bool m_bStop       = false;
+
+	std::vector<std::thread> m_threads;
+
+	// statistics
+	UINT64 m_nRequests  = 0;
+	UINT64 m_nSeeks     = 0;
+	UINT64 m_nWaits     = 0;
+	UINT64 m_downloaded = 0;
+	UINT64 m_nCacheHits = 0;
+	UINT64 m_cachedBytes = 0;
+
+	DWORD ChunkSize(const UINT64 index) const;
+	void Request(const UINT64 index, const bool bUrgent);
+	void DropQueued();
+	void EvictChunks();
+
+	void ThreadWorker();
+
+public:
+	CHTTPSegmentedReader(LPCWSTR lpszURL, const UINT64 lenght, LPCWSTR lpszValidator, LPCWSTR lpszCustomHeader = L"");
+	~CHTTPSegmentedReader();
+
+	HRESULT Read(const UINT64 position, BYTE* pBuffer, const DWORD dwSizeToRead);
+
+	// chunks read from the disk cache, chunks downloaded, bytes read from the disk cache
+	void GetCacheStatus(UINT64& hits, UINT64& misses, UINT64& bytes);
+};
@@ -19,6 +19,8 @@
  */
 
 #include "stdafx.h"
+#include <immintrin.h>
+#include "CPUInfo.h"
 #include "PixelUtils_AviSynth.h"
 #include "PixelUtils_VirtualDub.h"
 #include "PixelUtils.h"
@@ -103,6 +105,29 @@ void CopyOddLines(UINT h, BYTE* dst, UINT dst_pitch, BYTE* src, UINT src_pitch)
 	}
 }
 
+// dst[x] = (a[x] + b[x] + 1) >> 1
+static void AvgLine(BYTE* dst, const BYTE* a, const BYTE* b, const UINT len)
+{
+	UINT x = 0;
+
+	if (CPUInfo::HaveAVX2()) {
+		for (; x + 32 <= len; x += 32) {
+			const __m256i r = _mm256_avg_epu8(_mm256_loadu_si256((const __m256i*)(a + x)), _mm256_loadu_si256((const __m256i*)(b + x)));
+			_mm256_storeu_si256((__m256i*)(dst + x), r);
+		}
+		_mm256_zeroupper();
+	}
+
+	for (; x + 16 <= len; x += 16) {
+		const __m128i r = _mm_avg_epu8(_mm_loadu_si128((const __m128i*)(a + x)), _mm_loadu_si128((const __m128i*)(b + x)));
+		_mm_storeu_si128((__m128i*)(dst + x), r);
+	}
+
+	for (; x < len; x++) {
+		dst[x] = (a[x] + b[x] + 1) >> 1;
+	}
+}
+
 void AvgLines8_(BYTE* dst, DWORD h, DWORD pitch)
 {
 	if(h <= 1) return;
@@ -111,11 +136,7 @@ void AvgLines8_(BYTE* dst, DWORD h, DWORD pitch)
 	BYTE* d = dst + (h-2)*pitch;
 
 	for(; s < d; s += pitch*2) {
-		BYTE* tmp = s;
-
-		for(int i = pitch; i--; tmp++) {
-				tmp[pitch] = (tmp[0] + tmp[pitch<<1] + 1) >> 1;
-		}
+		AvgLine(s + pitch, s, s + pitch*2, pitch);
 	}
 
 	if(!(h&1)) {
@@ -135,3 +156,86 @@ void BobPlane(BYTE* dst, BYTE* src, UINT w, UINT h, UINT dstpitch, UINT srcpitch
 		AvgLines8_(dst + dstpitch, h-1, dstpitch);
 	}
 }
+
+// A pixel of the missing field is woven from the current frame when it and its vertical
+// neighbours are almost unchanged since the previous frame, otherwise it is interpolated.
+#define MOTION_THRESHOLD 10
+
+static void AdaptiveLine(BYTE* dst, const BYTE* cur, const BYTE* above, const BYTE* below,
+						 const BYTE* prev_cur, const BYTE* prev_above, const BYTE* prev_below, const UINT len)
+{
+	UINT x = 0;
+
+	if (CPUInfo::HaveAVX2()) {
+		const __m256i threshold = _mm256_set1_epi8(MOTION_THRESHOLD);
+		const __m256i zero = _mm256_setzero_si256();
+
+		for (; x + 32 <= len; x += 32) {
+			const __m256i c  = _mm256_loadu_si256((const __m256i*)(cur + x));
+			const __m256i a  = _mm256_loadu_si256((const __m256i*)(above + x));
+			const __m256i b  = _mm256_loadu_si256((const __m256i*)(below + x));
+			const __m256i pc = _mm256_loadu_si256((const __m256i*)(prev_cur + x));
+			const __m256i pa = _mm256_loadu_si256((const __m256i*)(prev_above + x));
+			const __m256i pb = _mm256_loadu_si256((const __m256i*)(prev_below + x));
+
+			__m256i motion = _mm256_or_si256(_mm256_subs_epu8(c, pc), _mm256_subs_epu8(pc, c));
+			motion = _mm256_max_epu8(motion, _mm256_or_si256(_mm256_subs_epu8(a, pa), _mm256_subs_epu8(pa, a)));
+			motion = _mm256_max_epu8(motion, _mm256_or_si256(_mm256_subs_epu8(b, pb), _mm256_subs_epu8(pb, b)));
+
+			const __m256i still = _mm256_cmpeq_epi8(_mm256_subs_epu8(motion, threshold), zero);
+			const __m256i r = _mm256_blendv_epi8(_mm256_avg_epu8(a, b), c, still);
+			_mm256_storeu_si256((__m256i*)(dst + x), r);
+		}
+		_mm256_zeroupper();
+	}
+
+	const __m128i threshold = _mm_set1_epi8(MOTION_THRESHOLD);
+	const __m128i zero = _mm_setzero_si128();
+
+	for (; x + 16 <= len; x += 16) {
+		const __m128i c  = _mm_loadu_si128((const __m128i*)(cur + x));
+		const __m128i a  = _mm_loadu_si128((const __m128i*)(above + x));
+		const __m128i b  = _mm_loadu_si128((const __m128i*)(below + x));
+		const __m128i pc = _mm_loadu_si128((const __m128i*)(prev_cur + x));
+		const __m128i pa = _mm_loadu_si128((const __m128i*)(prev_above + x));
+		const __m128i pb = _mm_loadu_si128((const __m128i*)(prev_below + x));
+
+		__m128i motion = _mm_or_si128(_mm_subs_epu8(c, pc), _mm_subs_epu8(pc, c));
+		motion = _mm_max_epu8(motion, _mm_or_si128(_mm_subs_epu8(a, pa), _mm_subs_epu8(pa, a)));
+		motion = _mm_max_epu8(motion, _mm_or_si128(_mm_subs_epu8(b, pb), _mm_subs_epu8(pb, b)));
+
+		const __m128i still = _mm_cmpeq_epi8(_mm_subs_epu8(motion, threshold), zero);
+		const __m128i r = _mm_or_si128(_mm_and_si128(still, c), _mm_andnot_si128(still, _mm_avg_epu8(a, b)));
+		_mm_storeu_si128((__m128i*)(dst + x), r);
+	}
+
+	for (; x < len; x++) {
+		const int motion = std::max({ abs(cur[x] - prev_cur[x]), abs(above[x] - prev_above[x]), abs(below[x] - prev_below[x]) });
+		dst[x] = motion <= MOTION_THRESHOLD ? cur[x] : (above[x] + below[x] + 1) >> 1;
+	}
+}
+
+void AdaptivePlane(BYTE* dst, const BYTE* src, const BYTE* prev, UINT w, UINT h, UINT dstpitch, UINT srcpitch, UINT prevpitch, bool topfield)
+{
+	if (h < 2) {
+		CopyPlane(h, dst, dstpitch, src, srcpitch);
+		return;
+	}
+
+	const UINT first = topfield ? 1 : 0; // first line of the missing field
+
+	for (UINT y = 0; y < h; y++) {
+		if ((y & 1) != first) {
+			memcpy(dst + dstpitch * y, src + srcpitch * y, w);
+			continue;
+		}
+
+		const UINT ya = y > 0 ? y - 1 : y + 1;
+		const UINT yb = y + 1 < h ? y + 1 : y - 1;
+
+		AdaptiveLine(dst + dstpitch * y,
+					 src + srcpitch * y, src + srcpitch * ya, src + srcpitch * yb,
+					 prev + prevpitch * y, prev + prevpitch * ya, prev + prevpitch * yb,
+					 w);
+	}
+}
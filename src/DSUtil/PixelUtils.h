@@ -29,3 +29,5 @@ extern void ConvertI420toYUY2(UINT h, BYTE* dst, UINT dst_pitch, const BYTE* con
 
 extern void BlendPlane(BYTE* dst, BYTE* src, UINT w, UINT h, UINT dstpitch, UINT srcpitch);
 extern void BobPlane(BYTE* dst, BYTE* src, UINT w, UINT h, UINT dstpitch, UINT srcpitch, bool topfield);
+// motion-adaptive deinterlacing, prev is the previous source frame
+extern void AdaptivePlane(BYTE* dst, const BYTE* src, const BYTE* prev, UINT w, UINT h, UINT dstpitch, UINT srcpitch, UINT prevpitch, bool topfield);
@@ -1,5 +1,5 @@
 /*
-* (C) 2017-2022 see Authors.txt
+* (C) 2017-2023 see Authors.txt
 *
 * This file is part of MPC-BE.
 *
@@ -20,6 +20,9 @@
 
 #include "stdafx.h"
 #include <ppl.h>
+#include <thread>
+#include <immintrin.h>
+#include "CPUInfo.h"
 #include "ResampleRGB32.h"
 
 // based on https://github.com/uploadcare/pillow-simd/blob/3.4.x/libImaging/Resample.c
@@ -241,50 +244,173 @@ int normalize_coeffs_8bpc(int outSize, int kmax, double *prekk, INT32 **kkp)
 	return kmax;
 }
 
+// Splits the rows into bands, one task for each row costs more than resampling of a small row.
+template <typename F>
+static void ParallelBands(const int rows, const int width, F func)
+{
+	const int cpus = std::max(1, (int)std::thread::hardware_concurrency());
+	const int bands = (rows * width < 64 * 1024) ? 1 : std::min(rows, cpus * 4);
+
+	if (bands == 1) {
+		func(0, rows);
+		return;
+	}
+
+	concurrency::parallel_for(0, bands, [&](int band) {
+		func(rows * band / bands, rows * (band + 1) / bands);
+	});
+}
+
+// The AVX2 functions give exactly the same results as the scalar code:
+// the integer sums do not depend on the order of additions, and the saturating
+// packs clip like the lookup table.
+
+static inline UINT32 PackPixel_SSE(__m128i ss)
+{
+	ss = _mm_srai_epi32(ss, PRECISION_BITS);
+	ss = _mm_packs_epi32(ss, ss);
+	ss = _mm_packus_epi16(ss, ss);
+	return (UINT32)_mm_cvtsi128_si32(ss);
+}
+
+static void ResampleLineHorizontal_AVX2(UINT32* const lineOut, const int destW, const BYTE* lineIn,
+										const INT32* const kk, const int kmax, const int* const bounds, const UINT32 mask)
+{
+	const __m256i idx = _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1);
+
+	for (int xx = 0; xx < destW; xx++) {
+		const INT32* k = &kk[xx * kmax];
+		const int xmin = bounds[xx * 2 + 0];
+		const int xmax = bounds[xx * 2 + 1];
+		const BYTE* p = lineIn + xmin * 4;
+
+		// two source pixels in one register
+		__m256i ss256 = _mm256_setzero_si256();
+		int x = 0;
+		for (; x + 2 <= xmax; x += 2) {
+			const __m256i pix = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(p + x * 4)));
+			const __m256i mmk = _mm256_permutevar8x32_epi32(_mm256_castsi128_si256(_mm_loadl_epi64((const __m128i*)(k + x))), idx);
+			ss256 = _mm256_add_epi32(ss256, _mm256_mullo_epi32(pix, mmk));
+		}
+
+		__m128i ss = _mm_add_epi32(_mm256_castsi256_si128(ss256), _mm256_extracti128_si256(ss256, 1));
+		ss = _mm_add_epi32(ss, _mm_set1_epi32(1 << (PRECISION_BITS - 1)));
+		if (x < xmax) {
+			const __m128i pix = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(*(const int*)(p + x * 4)));
+			ss = _mm_add_epi32(ss, _mm_mullo_epi32(pix, _mm_set1_epi32(k[x])));
+		}
+
+		lineOut[xx] = PackPixel_SSE(ss) & mask;
+	}
+
+	_mm256_zeroupper();
+}
+
+static void ResampleLineVertical_AVX2(UINT32* const lineOut, const int W, const BYTE* const src,
+									  const INT32* const k, const int ymin, const int ymax, const UINT32 mask)
+{
+	const __m256i round = _mm256_set1_epi32(1 << (PRECISION_BITS - 1));
+	const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	const __m256i mmmask = _mm256_set1_epi32(mask);
+
+	int xx = 0;
+
+	// eight pixels, two in each register
+	for (; xx + 8 <= W; xx += 8) {
+		__m256i ss0 = round;
+		__m256i ss1 = round;
+		__m256i ss2 = round;
+		__m256i ss3 = round;
+
+		for (int y = 0; y < ymax; y++) {
+			const BYTE* p = src + ((y + ymin) * W + xx) * 4;
+			const __m256i mmk = _mm256_set1_epi32(k[y]);
+			ss0 = _mm256_add_epi32(ss0, _mm256_mullo_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(p +  0))), mmk));
+			ss1 = _mm256_add_epi32(ss1, _mm256_mullo_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(p +  8))), mmk));
+			ss2 = _mm256_add_epi32(ss2, _mm256_mullo_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(p + 16))), mmk));
+			ss3 = _mm256_add_epi32(ss3, _mm256_mullo_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(p + 24))), mmk));
+		}
+
+		ss0 = _mm256_srai_epi32(ss0, PRECISION_BITS);
+		ss1 = _mm256_srai_epi32(ss1, PRECISION_BITS);
+		ss2 = _mm256_srai_epi32(ss2, PRECISION_BITS);
+		ss3 = _mm256_srai_epi32(ss3, PRECISION_BITS);
+
+		// the packs work inside the 128-bit lanes, the pixels are 0 2 4 6 1 3 5 7 after them
+		__m256i pix = _mm256_packus_epi16(_mm256_packs_epi32(ss0, ss1), _mm256_packs_epi32(ss2, ss3));
+		pix = _mm256_permutevar8x32_epi32(pix, order);
+		_mm256_storeu_si256((__m256i*)(lineOut + xx), _mm256_and_si256(pix, mmmask));
+	}
+
+	for (; xx < W; xx++) {
+		__m128i ss = _mm_set1_epi32(1 << (PRECISION_BITS - 1));
+		for (int y = 0; y < ymax; y++) {
+			const BYTE* p = src + ((y + ymin) * W + xx) * 4;
+			ss = _mm_add_epi32(ss, _mm_mullo_epi32(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(*(const int*)p)), _mm_set1_epi32(k[y])));
+		}
+
+		lineOut[xx] = PackPixel_SSE(ss) & mask;
+	}
+
+	_mm256_zeroupper();
+}
+
 void CResampleRGB32::ResampleHorizontal(BYTE* dest, int destW, int H, const BYTE* const src, int srcW)
 {
-	if (m_alpha) {
-		concurrency::parallel_for(0, H, [&](int yy) {
-			const BYTE* lineIn = src + yy * srcW * 4;
-			UINT32* const lineOut = (UINT32*)dest + yy * destW;
-
-			int ss0, ss1, ss2, ss3;
-			for (int xx = 0; xx < destW; xx++) {
-				const INT32* k = &m_kkHor[xx * m_kmaxHor];
-				const int xmin = m_boundsHor[xx * 2 + 0];
-				const int xmax = m_boundsHor[xx * 2 + 1];
-				ss0 = ss1 = ss2 = ss3 = 1 << (PRECISION_BITS - 1);
-
-				for (int x = 0; x < xmax; x++) {
-					ss0 += lineIn[(x + xmin) * 4 + 0] * k[x];
-					ss1 += lineIn[(x + xmin) * 4 + 1] * k[x];
-					ss2 += lineIn[(x + xmin) * 4 + 2] * k[x];
-					ss3 += lineIn[(x + xmin) * 4 + 3] * k[x];
+	if (CPUInfo::HaveAVX2()) {
+		const UINT32 mask = m_alpha ? 0xffffffff : 0x00ffffff;
+		ParallelBands(H, destW, [&](const int y0, const int y1) {
+			for (int yy = y0; yy < y1; yy++) {
+				ResampleLineHorizontal_AVX2((UINT32*)dest + yy * destW, destW, src + yy * srcW * 4, m_kkHor, m_kmaxHor, m_boundsHor, mask);
+			}
+		});
+	}
+	else if (m_alpha) {
+		ParallelBands(H, destW, [&](const int y0, const int y1) {
+			for (int yy = y0; yy < y1; yy++) {
+				const BYTE* lineIn = src + yy * srcW * 4;
+				UINT32* const lineOut = (UINT32*)dest + yy * destW;
+
+				int ss0, ss1, ss2, ss3;
+				for (int xx = 0; xx < destW; xx++) {
+					const INT32* k = &m_kkHor[xx * m_kmaxHor];
+					const int xmin = m_boundsHor[xx * 2 + 0];
+					const int xmax = m_boundsHor[xx * 2 + 1];
+					ss0 = ss1 = ss2 = ss3 = 1 << (PRECISION_BITS - 1);
+
+					for (int x = 0; x < xmax; x++) {
+						ss0 += lineIn[(x + xmin) * 4 + 0] * k[x];
+						ss1 += lineIn[(x + xmin) * 4 + 1] * k[x];
+						ss2 += lineIn[(x + xmin) * 4 + 2] * k[x];
+						ss3 += lineIn[(x + xmin) * 4 + 3] * k[x];
+					}
+
+					lineOut[xx] = MAKE_UINT32(clip8(ss0), clip8(ss1), clip8(ss2), clip8(ss3));
 				}
-
-				lineOut[xx] = MAKE_UINT32(clip8(ss0), clip8(ss1), clip8(ss2), clip8(ss3));
 			}
 		});
 	}
 	else {
-		concurrency::parallel_for(0, H, [&](int yy) {
-			const BYTE* lineIn = src + yy * srcW * 4;
-			UINT32* const lineOut = (UINT32*)dest + yy * destW;
-
-			int ss0, ss1, ss2;
-			for (int xx = 0; xx < destW; xx++) {
-				const INT32* k = &m_kkHor[xx * m_kmaxHor];
-				const int xmin = m_boundsHor[xx * 2 + 0];
-				const int xmax = m_boundsHor[xx * 2 + 1];
-				ss0 = ss1 = ss2 = 1 << (PRECISION_BITS - 1);
-
-				for (int x = 0; x < xmax; x++) {
-					ss0 += lineIn[(x + xmin) * 4 + 0] * k[x];
-					ss1 += lineIn[(x + xmin) * 4 + 1] * k[x];
-					ss2 += lineIn[(x + xmin) * 4 + 2] * k[x];
+		ParallelBands(H, destW, [&](const int y0, const int y1) {
+			for (int yy = y0; yy < y1; yy++) {
+				const BYTE* lineIn = src + yy * srcW * 4;
+				UINT32* const lineOut = (UINT32*)dest + yy * destW;
+
+				int ss0, ss1, ss2;
+				for (int xx = 0; xx < destW; xx++) {
+					const INT32* k = &m_kkHor[xx * m_kmaxHor];
+					const int xmin = m_boundsHor[xx * 2 + 0];
+					const int xmax = m_boundsHor[xx * 2 + 1];
+					ss0 = ss1 = ss2 = 1 << (PRECISION_BITS - 1);
+
+					for (int x = 0; x < xmax; x++) {
+						ss0 += lineIn[(x + xmin) * 4 + 0] * k[x];
+						ss1 += lineIn[(x + xmin) * 4 + 1] * k[x];
+						ss2 += lineIn[(x + xmin) * 4 + 2] * k[x];
+					}
+
+					lineOut[xx] = MAKE_UINT32(clip8(ss0), clip8(ss1), clip8(ss2), 0);
 				}
-
-				lineOut[xx] = MAKE_UINT32(clip8(ss0), clip8(ss1), clip8(ss2), 0);
 			}
 		});
 	}
@@ -292,44 +418,57 @@ void CResampleRGB32::ResampleHorizontal(BYTE* dest, int destW, int H, const BYTE
 
 void CResampleRGB32::ResampleVertical(BYTE* dest, int W, int destH, const BYTE* const src, int srcH)
 {
-	if (m_alpha) {
-		concurrency::parallel_for(0, destH, [&](int yy) {
-			UINT32* const lineOut = (UINT32*)dest + yy * W;
-			const INT32* k = &m_kkVer[yy * m_kmaxVer];
-			const int ymin = m_boundsVer[yy * 2 + 0];
-			const int ymax = m_boundsVer[yy * 2 + 1];
-			int ss0, ss1, ss2, ss3;
-			for (int xx = 0; xx < W; xx++) {
-				ss0 = ss1 = ss2 = ss3 = 1 << (PRECISION_BITS - 1);
-				for (int y = 0; y < ymax; y++) {
-					const BYTE* lineIn = src + (y + ymin) * W * 4;
-					ss0 += lineIn[xx * 4 + 0] * k[y];
-					ss1 += lineIn[xx * 4 + 1] * k[y];
-					ss2 += lineIn[xx * 4 + 2] * k[y];
-					ss3 += lineIn[xx * 4 + 3] * k[y];
+	if (CPUInfo::HaveAVX2()) {
+		const UINT32 mask = m_alpha ? 0xffffffff : 0x00ffffff;
+		ParallelBands(destH, W, [&](const int y0, const int y1) {
+			for (int yy = y0; yy < y1; yy++) {
+				ResampleLineVertical_AVX2((UINT32*)dest + yy * W, W, src,
+										  &m_kkVer[yy * m_kmaxVer], m_boundsVer[yy * 2 + 0], m_boundsVer[yy * 2 + 1], mask);
+			}
+		});
+	}
+	else if (m_alpha) {
+		ParallelBands(destH, W, [&](const int y0, const int y1) {
+			for (int yy = y0; yy < y1; yy++) {
+				UINT32* const lineOut = (UINT32*)dest + yy * W;
+				const INT32* k = &m_kkVer[yy * m_kmaxVer];
+				const int ymin = m_boundsVer[yy * 2 + 0];
+				const int ymax = m_boundsVer[yy * 2 + 1];
+				int ss0, ss1, ss2, ss3;
+				for (int xx = 0; xx < W; xx++) {
+					ss0 = ss1 = ss2 = ss3 = 1 << (PRECISION_BITS - 1);
+					for (int y = 0; y < ymax; y++) {
+						const BYTE* lineIn = src + (y + ymin) * W * 4;
+						ss0 += lineIn[xx * 4 + 0] * k[y];
+						ss1 += lineIn[xx * 4 + 1] * k[y];
+						ss2 += lineIn[xx * 4 + 2] * k[y];
+						ss3 += lineIn[xx * 4 + 3] * k[y];
+					}
+
+					lineOut[xx] = MAKE_UINT32(clip8(ss0), clip8(ss1), clip8(ss2), clip8(ss3));
 				}
-
-				lineOut[xx] = MAKE_UINT32(clip8(ss0), clip8(ss1), clip8(ss2), clip8(ss3));
 			}
 		});
 	}
 	else {
-		concurrency::parallel_for(0, destH, [&](int yy) {
-			UINT32* const lineOut = (UINT32*)dest + yy * W;
-			const INT32* k = &m_kkVer[yy * m_kmaxVer];
-			const int ymin = m_boundsVer[yy * 2 + 0];
-			const int ymax = m_boundsVer[yy * 2 + 1];
-			int ss0, ss1, ss2;
-			for (int xx = 0; xx < W; xx++) {
-				ss0 = ss1 = ss2 = 1 << (PRECISION_BITS - 1);
-				for (int y = 0; y < ymax; y++) {
-					const BYTE* lineIn = src + (y + ymin) * W * 4;
-					ss0 += lineIn[xx * 4 + 0] * k[y];
-					ss1 += lineIn[xx * 4 + 1] * k[y];
-					ss2 += lineIn[xx * 4 + 2] * k[y];
+		ParallelBands(destH, W, [&](const int y0, const int y1) {
+			for (int yy = y0; yy < y1; yy++) {
+				UINT32* const lineOut = (UINT32*)dest + yy * W;
+				const INT32* k = &m_kkVer[yy * m_kmaxVer];
+				const int ymin = m_boundsVer[yy * 2 + 0];
+				const int ymax = m_boundsVer[yy * 2 + 1];
+				int ss0, ss1, ss2;
+				for (int xx = 0; xx < W; xx++) {
+					ss0 = ss1 = ss2 = 1 << (PRECISION_BITS - 1);
+					for (int y = 0; y < ymax; y++) {
+						const BYTE* lineIn = src + (y + ymin) * W * 4;
+						ss0 += lineIn[xx * 4 + 0] * k[y];
+						ss1 += lineIn[xx * 4 + 1] * k[y];
+						ss2 += lineIn[xx * 4 + 2] * k[y];
+					}
+
+					lineOut[xx] = MAKE_UINT32(clip8(ss0), clip8(ss1), clip8(ss2), 0);
 				}
-
-				lineOut[xx] = MAKE_UINT32(clip8(ss0), clip8(ss1), clip8(ss2), 0);
 			}
 		});
 	}
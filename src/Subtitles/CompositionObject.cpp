@@ -23,6 +23,119 @@
 #include "ColorConvert.h"
 #include "DSUtil/GolombBuffer.h"
 #include <d3d9types.h>
+#include <immintrin.h>
+
+static DWORD HashData(const BYTE* data, size_t size)
+{
+	// FNV-1a over 32-bit words, the tail is hashed byte by byte
+	DWORD hash = 2166136261u;
+	const size_t size4 = size & ~3;
+	for (size_t i = 0; i < size4; i += 4) {
+		hash = (hash ^ *(const DWORD*)(data + i)) * 16777619u;
+	}
+	for (size_t i = size4; i < size; i++) {
+		hash = (hash ^ data[i]) * 16777619u;
+	}
+	return hash;
+}
+
+static void ApplyPalette(DWORD* dst, const BYTE* src, int count, const DWORD* palette, bool bUseAVX2)
+{
+	int i = 0;
+	if (bUseAVX2) {
+		for (; i + 8 <= count; i += 8) {
+			const __m256i idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_i32gather_epi32(reinterpret_cast<const int*>(palette), idx, 4));
+		}
+	}
+	for (; i + 4 <= count; i += 4) {
+		dst[i + 0] = palette[src[i + 0]];
+		dst[i + 1] = palette[src[i + 1]];
+		dst[i + 2] = palette[src[i + 2]];
+		dst[i + 3] = palette[src[i + 3]];
+	}
+	for (; i < count; i++) {
+		dst[i] = palette[src[i]];
+	}
+}
+
+// Per-pixel version of Rasterizer::FillSolidRect(), the result is bit-exact with it.
+// A pixel with zero alpha leaves the destination unchanged.
+static void BlendRow(DWORD* dst, const DWORD* src, int count)
+{
+	const __m128i zero       = _mm_setzero_si128();
+	const __m128i c256       = _mm_set1_epi16(256);
+	const __m128i ones       = _mm_set1_epi16(1);
+	const __m128i color_mask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+		const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+
+		__m128i r[2];
+		for (int k = 0; k < 2; k++) {
+			const __m128i d16 = k ? _mm_unpackhi_epi8(d, zero) : _mm_unpacklo_epi8(d, zero);
+			const __m128i s16 = k ? _mm_unpackhi_epi8(s, zero) : _mm_unpacklo_epi8(s, zero);
+			const __m128i a   = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s16, 0xFF), 0xFF);
+			const __m128i ia  = _mm_sub_epi16(c256, a);
+			const __m128i a1  = _mm_add_epi16(a, ones);
+			// d * (256 - a) + s * (a + 1) never exceeds 0xFFFF
+			__m128i v = _mm_add_epi16(_mm_mullo_epi16(d16, ia), _mm_mullo_epi16(_mm_and_si128(s16, color_mask), a1));
+			r[k] = _mm_srli_epi16(v, 8);
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(r[0], r[1]));
+	}
+
+	for (; i < count; i++) {
+		const DWORD color = src[i];
+		const DWORD a  = color >> 24;
+		const DWORD ia = 256 - a;
+		const DWORD a1 = a + 1;
+		const DWORD d  = dst[i];
+
+		dst[i] = ((((d & 0x00ff00ff) * ia + (color & 0x00ff00ff) * a1) & 0xff00ff00) >> 8) |
+				 ((((d & 0x0000ff00) * ia + (color & 0x0000ff00) * a1) & 0x00ff0000) >> 8) |
+				 ((((d >> 8) & 0x00ff0000) * ia) & 0xff000000);
+	}
+}
+
+CDecodedObjectSharedPtr CDecodedObjectCache::Lookup(const CDecodedObjectKey& key)
+{
+	for (auto it = m_list.begin(); it != m_list.end(); ++it) {
+		if (it->first == key) {
+			m_list.splice(m_list.begin(), m_list, it);
+			m_hits++;
+			return m_list.front().second;
+		}
+	}
+
+	m_misses++;
+	return nullptr;
+}
+
+void CDecodedObjectCache::Add(const CDecodedObjectKey& key, const CDecodedObjectSharedPtr& pDecoded)
+{
+	const size_t size = pDecoded->GetSize();
+	if (size > m_maxSize) {
+		return;
+	}
+
+	while (!m_list.empty() && m_size + size > m_maxSize) {
+		m_size -= m_list.back().second->GetSize();
+		m_list.pop_back();
+	}
+
+	m_list.emplace_front(key, pDecoded);
+	m_size += size;
+}
+
+void CDecodedObjectCache::Clear()
+{
+	m_list.clear();
+	m_size = 0;
+}
 
 CompositionObject::CompositionObject()
 {
@@ -53,6 +166,7 @@ void CompositionObject::SetRLEData(const BYTE* pBuffer, int nSize, int nTotalSiz
 	m_pRLEData		= DNew BYTE[nTotalSize];
 	m_nRLEDataSize	= nTotalSize;
 	m_nRLEPos		= std::min(nSize, nTotalSize);
+	m_bRLEHash		= false;
 
 	memcpy(m_pRLEData, pBuffer, std::min(nSize, nTotalSize));
 }
@@ -63,25 +177,81 @@ void CompositionObject::AppendRLEData(const BYTE* pBuffer, int nSize)
 	if (m_nRLEPos + nSize <= m_nRLEDataSize) {
 		memcpy(m_pRLEData + m_nRLEPos, pBuffer, nSize);
 		m_nRLEPos += nSize;
+		m_bRLEHash = false;
 	}
 }
 
-void CompositionObject::RenderHdmv(SubPicDesc& spd, SubPicDesc* spdResized)
+void CompositionObject::RenderHdmv(SubPicDesc& spd, SubPicDesc* spdResized, CDecodedObjectCache* pCache/* = nullptr*/)
 {
-	if (!m_pRLEData || !m_nColorNumber) {
+	if (!m_pRLEData || !m_nColorNumber || m_width <= 0 || m_height <= 0) {
 		return;
 	}
 
+	CDecodedObjectSharedPtr pDecoded;
+	CDecodedObjectKey key;
+
+	if (pCache) {
+		key = GetDecodedObjectKey();
+		pDecoded = pCache->Lookup(key);
+	}
+
+	if (!pDecoded) {
+		pDecoded = DecodeHdmv();
+		if (!pDecoded) {
+			return;
+		}
+
+		if (pCache) {
+			pCache->Add(key, pDecoded);
+		}
+	}
+
+	DrawDecoded(spdResized ? *spdResized : spd, *pDecoded, m_horizontal_position, m_vertical_position);
+}
+
+CDecodedObjectKey CompositionObject::GetDecodedObjectKey()
+{
+	if (!m_bRLEHash) {
+		m_nRLEHash = HashData(m_pRLEData, m_nRLEDataSize);
+		m_bRLEHash = true;
+	}
+
+	CDecodedObjectKey key;
+	key.object_id   = m_object_id_ref;
+	key.version     = m_version_number;
+	key.width       = m_width;
+	key.height      = m_height;
+	key.rleSize     = m_nRLEDataSize;
+	key.rleHash     = m_nRLEHash;
+	key.paletteHash = HashData((const BYTE*)m_Colors, sizeof(m_Colors));
+
+	return key;
+}
+
+CDecodedObjectSharedPtr CompositionObject::DecodeHdmv() const
+{
+	auto pDecoded = std::make_shared<CDecodedObject>();
+	pDecoded->width  = m_width;
+	pDecoded->height = m_height;
+	pDecoded->pixels.reset(new(std::nothrow) DWORD[(size_t)m_width * m_height]);
+	pDecoded->spans.reset(new(std::nothrow) std::pair<SHORT, SHORT>[m_height]);
+	std::unique_ptr<BYTE[]> pIndexes(new(std::nothrow) BYTE[(size_t)m_width * m_height]);
+	if (!pDecoded->pixels || !pDecoded->spans || !pIndexes) {
+		return nullptr;
+	}
+
+	memset(pIndexes.get(), 0xFF, (size_t)m_width * m_height);
+
 	CGolombBuffer	GBuffer (m_pRLEData, m_nRLEDataSize);
 	BYTE			bTemp;
 	BYTE			bSwitch;
 
 	BYTE			nPaletteIndex = 0;
 	SHORT			nCount;
-	SHORT			nX	= m_horizontal_position;
-	SHORT			nY	= m_vertical_position;
+	SHORT			nX	= 0;
+	SHORT			nY	= 0;
 
-	while ((nY < (m_vertical_position + m_height)) && !GBuffer.IsEOF()) {
+	while (nY < m_height && !GBuffer.IsEOF()) {
 		bTemp = GBuffer.ReadByte();
 
 		nPaletteIndex = bTemp;
@@ -97,13 +267,48 @@ void CompositionObject::RenderHdmv(SubPicDesc& spd, SubPicDesc* spdResized)
 		}
 
 		if (nCount > 0) {
-			if (nPaletteIndex != 0xFF) {	// Fully transparent (section 9.14.4.2.2.1.1)
-				FillSolidRect(spdResized ? *spdResized : spd, nX, nY, nCount, 1, m_Colors[nPaletteIndex]);
+			if (nPaletteIndex != 0xFF && nX < m_width) {	// Fully transparent (section 9.14.4.2.2.1.1)
+				memset(pIndexes.get() + (size_t)nY * m_width + nX, nPaletteIndex, std::min<int>(nCount, m_width - nX));
 			}
 			nX += nCount;
 		} else {
 			nY++;
-			nX = m_horizontal_position;
+			nX = 0;
+		}
+	}
+
+	DWORD palette[256];
+	memcpy(palette, m_Colors, sizeof(palette));
+	palette[0xFF] = 0;
+
+	for (int y = 0; y < m_height; y++) {
+		const BYTE* src = pIndexes.get() + (size_t)y * m_width;
+
+		SHORT first = 0, last = m_width;
+		while (first < last && src[first] == 0xFF) {
+			first++;
+		}
+		while (last > first && src[last - 1] == 0xFF) {
+			last--;
+		}
+		pDecoded->spans[y] = { first, last };
+
+		ApplyPalette(pDecoded->pixels.get() + (size_t)y * m_width + first, src + first, last - first, palette, m_bUseAVX2);
+	}
+
+	return pDecoded;
+}
+
+void CompositionObject::DrawDecoded(SubPicDesc& spd, const CDecodedObject& decoded, int nX, int nY) const
+{
+	const int height = std::min(decoded.height, spd.h - nY);
+	for (int y = std::max(0, -nY); y < height; y++) {
+		const auto& span = decoded.spans[y];
+		const int first = std::max<int>(span.first, -nX);
+		const int last  = std::min<int>(span.second, spd.w - nX);
+		if (first < last) {
+			DWORD* dst = (DWORD*)(spd.bits + spd.pitch * (nY + y)) + nX + first;
+			BlendRow(dst, decoded.pixels.get() + (size_t)y * decoded.width + first, last - first);
 		}
 	}
 }
@@ -33,6 +33,55 @@ struct HDMV_PALETTE {
 
 class CGolombBuffer;
 
+// RLE bitmap with the palette already applied, transparent pixels are 0
+struct CDecodedObject {
+	int width  = 0;
+	int height = 0;
+	std::unique_ptr<DWORD[]> pixels;
+	std::unique_ptr<std::pair<SHORT, SHORT>[]> spans; // visible [first, last) pixels of each row
+
+	size_t GetSize() const { return (size_t)width * height * (sizeof(DWORD) + 1) + height * sizeof(spans[0]); }
+};
+
+typedef std::shared_ptr<CDecodedObject> CDecodedObjectSharedPtr;
+
+struct CDecodedObjectKey {
+	SHORT object_id    = 0;
+	BYTE  version      = 0;
+	SHORT width        = 0;
+	SHORT height       = 0;
+	int   rleSize      = 0;
+	DWORD rleHash      = 0;
+	DWORD paletteHash  = 0;
+
+	bool operator==(const CDecodedObjectKey& key) const {
+		return object_id == key.object_id && version == key.version
+			   && width == key.width && height == key.height
+			   && rleSize == key.rleSize && rleHash == key.rleHash
+			   && paletteHash == key.paletteHash;
+	}
+};
+
+// LRU cache of decoded objects limited by the total size of the bitmaps
+class CDecodedObjectCache
+{
+	std::list<std::pair<CDecodedObjectKey, CDecodedObjectSharedPtr>> m_list;
+	size_t m_maxSize;
+	size_t m_size   = 0;
+	UINT64 m_hits   = 0;
+	UINT64 m_misses = 0;
+
+public:
+	CDecodedObjectCache(size_t maxSize) : m_maxSize(maxSize) {};
+
+	CDecodedObjectSharedPtr Lookup(const CDecodedObjectKey& key);
+	void Add(const CDecodedObjectKey& key, const CDecodedObjectSharedPtr& pDecoded);
+	void Clear();
+
+	UINT64 GetHits() const { return m_hits; }
+	UINT64 GetMisses() const { return m_misses; }
+};
+
 class CompositionObject : Rasterizer
 {
 public :
@@ -66,7 +115,7 @@ public :
 	const BYTE*			GetRLEData() { return m_pRLEData; };
 	bool				IsRLEComplete() { return m_nRLEPos >= m_nRLEDataSize; };
 
-	void				RenderHdmv(SubPicDesc& spd, SubPicDesc* spdResized);
+	void				RenderHdmv(SubPicDesc& spd, SubPicDesc* spdResized, CDecodedObjectCache* pCache = nullptr);
 	void				RenderDvb(SubPicDesc& spd, SHORT nX, SHORT nY, SubPicDesc* spdResized);
 	void				RenderXSUB(SubPicDesc& spd);
 
@@ -87,9 +136,15 @@ private :
 	BYTE*	m_pRLEData		= NULL;
 	int		m_nRLEDataSize	= 0;
 	int		m_nRLEPos		= 0;
+	DWORD	m_nRLEHash		= 0;
+	bool	m_bRLEHash		= false;
 	int		m_nColorNumber	= 0;
 	DWORD	m_Colors[256];
 
+	CDecodedObjectKey		GetDecodedObjectKey();
+	CDecodedObjectSharedPtr	DecodeHdmv() const;
+	void					DrawDecoded(SubPicDesc& spd, const CDecodedObject& decoded, int nX, int nY) const;
+
 	void	DvbRenderField(SubPicDesc& spd, CGolombBuffer& gb, SHORT nXStart, SHORT nYStart, SHORT nLength);
 	void	Dvb2PixelsCodeString(SubPicDesc& spd, CGolombBuffer& gb, SHORT& nX, SHORT& nY);
 	void	Dvb4PixelsCodeString(SubPicDesc& spd, CGolombBuffer& gb, SHORT& nX, SHORT& nY);
@@ -30,11 +30,15 @@
 
 CHdmvSub::CHdmvSub()
 	: CBaseSub(ST_HDMV)
+	, m_DecodedObjects(128 * 1024 * 1024)
 {
 }
 
 CHdmvSub::~CHdmvSub()
 {
+	TRACE_HDMVSUB(L"CHdmvSub::~CHdmvSub() : decoded objects cache hits %I64u, misses %I64u",
+				  m_DecodedObjects.GetHits(), m_DecodedObjects.GetMisses());
+
 	Reset();
 
 	SAFE_DELETE_ARRAY(m_pSegBuffer);
@@ -217,7 +221,7 @@ HRESULT CHdmvSub::Render(SubPicDesc& spd, REFERENCE_TIME rt, RECT& bbox)
 							  rt, ReftimeToString(rt));
 
 				InitSpd(spd, m_VideoDescriptor.nVideoWidth, m_VideoDescriptor.nVideoHeight);
-				pObject->RenderHdmv(spd, m_bResizedRender ? &m_spd : nullptr);
+				pObject->RenderHdmv(spd, m_bResizedRender ? &m_spd : nullptr, &m_DecodedObjects);
 
 				hr = S_OK;
 			}
@@ -112,6 +112,9 @@ private :
 	HDMV_CLUT                    m_CLUT[256];
 	HDMV_CLUT                    m_DefaultCLUT;
 
+	// survives Reset() so that seeking back does not decode the same objects again
+	CDecodedObjectCache          m_DecodedObjects;
+
 	void UpdateTimeStamp(REFERENCE_TIME rtStop);
 	void ParsePresentationSegment(CGolombBuffer* pGBuffer, REFERENCE_TIME rtTime);
 	void EnqueuePresentationSegment();
@@ -32,6 +32,59 @@ static long revcolor(long c)
 	return ((c & 0xff0000) >> 16) + (c & 0xff00) + ((c & 0xff) << 16);
 }
 
+// Glyph outlines depend only on the font and the character, so they are shared
+// by all words and all renderer instances for the lifetime of the process.
+static CGlyphPathCache g_glyphPathCache(8192);
+static std::mutex g_glyphPathCacheMutex;
+static UINT64 g_glyphPathCacheHits = 0;
+static UINT64 g_glyphPathCacheMisses = 0;
+
+// Characters for which GDI draws the same outline regardless of the neighboring characters.
+static inline bool IsStandaloneGlyph(WCHAR c)
+{
+	return c < 0x0300                      // Latin
+		   || (c >= 0x0370 && c < 0x0530)  // Greek, Cyrillic
+		   || (c >= 0x3000 && c < 0xA000)  // CJK symbols, Kana, CJK ideographs
+		   || (c >= 0xAC00 && c < 0xD7A4)  // Hangul syllables
+		   || (c >= 0xFF00 && c < 0xFFF0); // Halfwidth and Fullwidth Forms
+}
+
+static CGlyphPathSharedPtr CreateGlyphPath(WCHAR c)
+{
+	CSize extent;
+	TEXTMETRICW tm;
+	if (!GetTextExtentPoint32W(g_hDC, &c, 1, &extent) || !GetTextMetricsW(g_hDC, &tm)) {
+		ASSERT(0);
+		return nullptr;
+	}
+
+	if (!::BeginPath(g_hDC)) {
+		return nullptr;
+	}
+	TextOutW(g_hDC, 0, 0, &c, 1);
+	::CloseFigure(g_hDC);
+	if (!::EndPath(g_hDC)) {
+		::AbortPath(g_hDC);
+		return nullptr;
+	}
+
+	auto pGlyphPath = std::make_shared<CGlyphPath>();
+	pGlyphPath->advance  = extent.cx;
+	pGlyphPath->overhang = tm.tmOverhang;
+
+	const int nPoints = GetPath(g_hDC, nullptr, nullptr, 0);
+	if (nPoints > 0) {
+		pGlyphPath->types.SetCount(nPoints);
+		pGlyphPath->points.SetCount(nPoints);
+		if (nPoints != GetPath(g_hDC, pGlyphPath->points.GetData(), pGlyphPath->types.GetData(), nPoints)) {
+			ASSERT(0);
+			return nullptr;
+		}
+	}
+
+	return pGlyphPath;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 
 void alpha_mask_deleter::operator()(CAlphaMask* ptr) const noexcept
@@ -495,44 +548,92 @@ bool CText::Append(CWord* w)
 	return (dynamic_cast<CText*>(w) && CWord::Append(w));
 }
 
-bool CText::CreatePath()
+bool CText::CreatePathFromGlyphs()
 {
-	CMyFont font(m_style);
+	std::unique_lock<std::mutex> lock(g_glyphPathCacheMutex);
 
-	HFONT hOldFont = SelectFont(g_hDC, font);
+	std::unique_ptr<CMyFont> pFont;
+	HFONT hOldFont = nullptr;
 
-	if (m_style.fontSpacing) {
-		int width = 0;
-		bool bFirstPath = true;
+	bool ret = true;
+	int width = 0;
+	bool bFirstPath = true;
 
-		for (LPCWSTR s = m_str; *s; s++) {
-			CSize extent;
-			if (!GetTextExtentPoint32W(g_hDC, s, 1, &extent)) {
-				SelectFont(g_hDC, hOldFont);
-				ASSERT(0);
-				return false;
+	for (LPCWSTR s = m_str; *s; s++) {
+		CGlyphPathKey glyphPathKey(m_style, *s);
+		CGlyphPathSharedPtr pGlyphPath;
+
+		if (g_glyphPathCache.Lookup(glyphPathKey, pGlyphPath)) {
+			g_glyphPathCacheHits++;
+		} else {
+			g_glyphPathCacheMisses++;
+
+			if (!pFont) {
+				pFont.reset(DNew CMyFont(m_style));
+				hOldFont = SelectFont(g_hDC, *pFont);
 			}
 
-			PartialBeginPath(g_hDC, bFirstPath);
-			bFirstPath = false;
-			TextOutW(g_hDC, 0, 0, s, 1);
-			PartialEndPath(g_hDC, width, 0);
+			pGlyphPath = CreateGlyphPath(*s);
+			if (!pGlyphPath) {
+				ret = false;
+				break;
+			}
 
-			width += extent.cx + (int)m_style.fontSpacing;
+			g_glyphPathCache.SetAt(glyphPathKey, pGlyphPath);
 		}
-	} else {
-		CSize extent;
-		if (!GetTextExtentPoint32W(g_hDC, m_str, m_str.GetLength(), &extent)) {
-			SelectFont(g_hDC, hOldFont);
-			ASSERT(0);
-			return false;
+
+		if (!AppendPath(pGlyphPath->types.GetData(), pGlyphPath->points.GetData(), (int)pGlyphPath->points.GetCount(), width, 0, bFirstPath)) {
+			ret = false;
+			break;
+		}
+		bFirstPath = false;
+
+		if (m_style.fontSpacing) {
+			width += pGlyphPath->advance + (int)m_style.fontSpacing;
+		} else {
+			width += pGlyphPath->advance - pGlyphPath->overhang;
+		}
+	}
+
+	if (pFont) {
+		SelectFont(g_hDC, hOldFont);
+	}
+
+	return ret;
+}
+
+bool CText::CreatePath()
+{
+	// With letter spacing every character is drawn separately anyway.
+	// Otherwise the word can be assembled from cached glyphs only when
+	// no shaping is involved and no underline/strikeout spans the whole word.
+	bool bUseGlyphs = true;
+	if (!m_style.fontSpacing) {
+		bUseGlyphs = !m_style.fUnderline && !m_style.fStrikeOut;
+		for (LPCWSTR s = m_str; bUseGlyphs && *s; s++) {
+			bUseGlyphs = IsStandaloneGlyph(*s);
 		}
+	}
+
+	if (bUseGlyphs) {
+		return CreatePathFromGlyphs();
+	}
+
+	CMyFont font(m_style);
+
+	HFONT hOldFont = SelectFont(g_hDC, font);
 
-		BeginPath(g_hDC);
-		TextOutW(g_hDC, 0, 0, m_str, m_str.GetLength());
-		EndPath(g_hDC);
+	CSize extent;
+	if (!GetTextExtentPoint32W(g_hDC, m_str, m_str.GetLength(), &extent)) {
+		SelectFont(g_hDC, hOldFont);
+		ASSERT(0);
+		return false;
 	}
 
+	BeginPath(g_hDC);
+	TextOutW(g_hDC, 0, 0, m_str, m_str.GetLength());
+	EndPath(g_hDC);
+
 	SelectFont(g_hDC, hOldFont);
 
 	return true;
@@ -1648,6 +1749,15 @@ CRenderedTextSubtitle::~CRenderedTextSubtitle()
 {
 	Deinit();
 
+#ifdef DEBUG_OR_LOG
+	{
+		std::unique_lock<std::mutex> lock(g_glyphPathCacheMutex);
+		const UINT64 total = g_glyphPathCacheHits + g_glyphPathCacheMisses;
+		DLogIf(total, L"CRenderedTextSubtitle : glyph path cache hits %I64u / %I64u (%.1f%%)",
+			   g_glyphPathCacheHits, total, 100.0 * g_glyphPathCacheHits / total);
+	}
+#endif
+
 	g_hDC_refcnt--;
 	if (g_hDC_refcnt == 0) {
 		DeleteDC(g_hDC);
@@ -35,6 +35,14 @@ struct CPolygonPath {
 	CSize size;
 };
 
+// Outline of a single glyph as returned by GetPath, shared between all CText instances
+struct CGlyphPath {
+	CAtlArray<BYTE> types;
+	CAtlArray<POINT> points;
+	int advance;  // GetTextExtentPoint32W width of the glyph
+	int overhang; // TEXTMETRIC::tmOverhang of the font
+};
+
 struct CAlphaMask;
 
 struct alpha_mask_deleter {
@@ -74,12 +82,14 @@ struct CAlphaMask final : std::unique_ptr<BYTE[]> {
 };
 
 typedef std::shared_ptr<CPolygonPath> CPolygonPathSharedPtr;
+typedef std::shared_ptr<CGlyphPath> CGlyphPathSharedPtr;
 struct SSATag;
 typedef std::shared_ptr<CAtlList<SSATag>> SSATagsList;
 typedef std::shared_ptr<CAlphaMask> CAlphaMaskSharedPtr;
 
 typedef CRenderingCache<CTextDimsKey, CTextDims, CKeyTraits<CTextDimsKey>> CTextDimsCache;
 typedef CRenderingCache<CPolygonPathKey, CPolygonPathSharedPtr, CKeyTraits<CPolygonPathKey>> CPolygonCache;
+typedef CRenderingCache<CGlyphPathKey, CGlyphPathSharedPtr, CKeyTraits<CGlyphPathKey>> CGlyphPathCache;
 typedef CRenderingCache<CStringW, SSATagsList, CStringElementTraits<CStringW>> CSSATagsCache;
 typedef CRenderingCache<CEllipseKey, CEllipseSharedPtr, CKeyTraits<CEllipseKey>> CEllipseCache;
 typedef CRenderingCache<COutlineKey, COutlineDataSharedPtr, CKeyTraits<COutlineKey>> COutlineCache;
@@ -166,6 +176,8 @@ public:
 
 class CText : public CWord
 {
+	bool CreatePathFromGlyphs();
+
 protected:
 	virtual bool CreatePath();
 
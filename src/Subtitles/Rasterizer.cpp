@@ -326,6 +326,41 @@ bool Rasterizer::PartialEndPath(HDC hdc, long dx, long dy)
 	return false;
 }
 
+bool Rasterizer::AppendPath(const BYTE* pTypes, const POINT* pPoints, int nPoints, long dx, long dy, bool bClearPath)
+{
+	if (bClearPath) {
+		_TrashPath();
+	}
+
+	if (nPoints < 1) {
+		return true;
+	}
+
+	BYTE* pNewTypes = (BYTE*)realloc(mpPathTypes, (mPathPoints + nPoints) * sizeof(BYTE));
+	if (pNewTypes) {
+		mpPathTypes = pNewTypes;
+	}
+
+	POINT* pNewPoints = (POINT*)realloc(mpPathPoints, (mPathPoints + nPoints) * sizeof(POINT));
+	if (pNewPoints) {
+		mpPathPoints = pNewPoints;
+	}
+
+	if (!pNewTypes || !pNewPoints) {
+		return false;
+	}
+
+	memcpy(mpPathTypes + mPathPoints, pTypes, nPoints * sizeof(BYTE));
+	for (ptrdiff_t i = 0; i < nPoints; ++i) {
+		mpPathPoints[mPathPoints + i].x = pPoints[i].x + dx;
+		mpPathPoints[mPathPoints + i].y = pPoints[i].y + dy;
+	}
+
+	mPathPoints += nPoints;
+
+	return true;
+}
+
 bool Rasterizer::ScanConvert()
 {
 	try {
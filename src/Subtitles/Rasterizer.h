@@ -178,6 +178,7 @@ public:
 	bool EndPath(HDC hdc);
 	bool PartialBeginPath(HDC hdc, bool bClearPath);
 	bool PartialEndPath(HDC hdc, long dx, long dy);
+	bool AppendPath(const BYTE* pTypes, const POINT* pPoints, int nPoints, long dx, long dy, bool bClearPath);
 	bool ScanConvert();
 	bool CreateWidenedRegion(int borderX, int borderY);
 	bool Rasterize(int xsub, int ysub, int fBlur, double fGaussianBlur);
@@ -108,6 +108,63 @@ bool CPolygonPathKey::operator==(const CPolygonPathKey& polygonPathKey) const
 		   && NEARLY_EQ(m_scaley, polygonPathKey.m_scaley, 1e-6);
 }
 
+CGlyphPathKey::CGlyphPathKey(const STSStyle& style, WCHAR glyph)
+	: m_fontName(style.fontName)
+	, m_charSet(style.charSet)
+	, m_fontHeight((LONG)(style.fontSize + 0.5)) // same rounding as CMyFont
+	, m_fontWeight(style.fontWeight)
+	, m_fItalic(style.fItalic)
+	, m_fUnderline(style.fUnderline)
+	, m_fStrikeOut(style.fStrikeOut)
+	, m_glyph(glyph)
+{
+	UpdateHash();
+}
+
+CGlyphPathKey::CGlyphPathKey(const CGlyphPathKey& glyphPathKey)
+	: m_hash(glyphPathKey.m_hash)
+	, m_fontName(glyphPathKey.m_fontName)
+	, m_charSet(glyphPathKey.m_charSet)
+	, m_fontHeight(glyphPathKey.m_fontHeight)
+	, m_fontWeight(glyphPathKey.m_fontWeight)
+	, m_fItalic(glyphPathKey.m_fItalic)
+	, m_fUnderline(glyphPathKey.m_fUnderline)
+	, m_fStrikeOut(glyphPathKey.m_fStrikeOut)
+	, m_glyph(glyphPathKey.m_glyph)
+{
+}
+
+void CGlyphPathKey::UpdateHash()
+{
+	m_hash  = m_glyph;
+	m_hash += m_hash << 5;
+	m_hash += CStringElementTraits<CString>::Hash(m_fontName);
+	m_hash += m_hash << 5;
+	m_hash += m_charSet;
+	m_hash += m_hash << 5;
+	m_hash += m_fontHeight;
+	m_hash += m_hash << 5;
+	m_hash += m_fontWeight;
+	m_hash += m_hash << 5;
+	m_hash += m_fItalic;
+	m_hash += m_hash << 5;
+	m_hash += m_fUnderline;
+	m_hash += m_hash << 5;
+	m_hash += m_fStrikeOut;
+}
+
+bool CGlyphPathKey::operator==(const CGlyphPathKey& glyphPathKey) const
+{
+	return m_glyph == glyphPathKey.m_glyph
+		   && m_fontHeight == glyphPathKey.m_fontHeight
+		   && m_fontWeight == glyphPathKey.m_fontWeight
+		   && m_charSet == glyphPathKey.m_charSet
+		   && m_fItalic == glyphPathKey.m_fItalic
+		   && m_fUnderline == glyphPathKey.m_fUnderline
+		   && m_fStrikeOut == glyphPathKey.m_fStrikeOut
+		   && m_fontName == glyphPathKey.m_fontName;
+}
+
 COutlineKey::COutlineKey(const CWord* word, CPoint org)
 	: CTextDimsKey(word->m_str, word->m_style)
 	, m_scalex(word->m_scalex)
@@ -132,6 +132,32 @@ public:
 	bool operator==(const CPolygonPathKey& polygonPathKey) const;
 };
 
+class CGlyphPathKey
+{
+private:
+	ULONG m_hash;
+
+protected:
+	CString m_fontName;
+	int m_charSet;
+	LONG m_fontHeight;
+	LONG m_fontWeight;
+	int m_fItalic;
+	int m_fUnderline;
+	int m_fStrikeOut;
+	WCHAR m_glyph;
+
+public:
+	CGlyphPathKey(const STSStyle& style, WCHAR glyph);
+	CGlyphPathKey(const CGlyphPathKey& glyphPathKey);
+
+	ULONG GetHash() const { return m_hash; };
+
+	void UpdateHash();
+
+	bool operator==(const CGlyphPathKey& glyphPathKey) const;
+};
+
 class CEllipseKey
 {
 private:
@@ -627,7 +627,9 @@ void CAppSettings::ResetSettings()
 	bAudioNormBoost = true;
 	iAudioNormLevel = 75;
 	iAudioNormRealeaseTime = 8;
+	iAudioNormLookahead = 5;
 	iAudioSampleFormats = SFMT_MASK;
+	bAudioDitherNoiseShaping = false;
 	bAudioTimeShift = false;
 	iAudioTimeShift = 0;
 	bAudioFilters = false;
@@ -753,6 +755,7 @@ void CAppSettings::ResetSettings()
 	fSmartSeek = false;
 	iSmartSeekSize = 15;
 	iSmartSeekVR = 0;
+	bSmartSeekSprites = true;
 	fChapterMarker = false;
 	fFlybar = true;
 	iPlsFontPercent = 100;
@@ -1028,8 +1031,10 @@ void CAppSettings::LoadSettings(bool bForce/* = false*/)
 	profile.ReadBool(IDS_R_AUDIO, IDS_RS_AUDIONORMBOOST, bAudioNormBoost);
 	profile.ReadInt(IDS_R_AUDIO, IDS_RS_AUDIONORMLEVEL, iAudioNormLevel, 0, 100);
 	profile.ReadInt(IDS_R_AUDIO, IDS_RS_AUDIONORMREALEASETIME, iAudioNormRealeaseTime, 5, 10);
+	profile.ReadInt(IDS_R_AUDIO, IDS_RS_AUDIONORMLOOKAHEAD, iAudioNormLookahead, 0, 100);
 	profile.ReadInt(IDS_R_AUDIO, IDS_RS_AUDIOSAMPLEFORMATS, iAudioSampleFormats);
 	iAudioSampleFormats &= SFMT_MASK;
+	profile.ReadBool(IDS_R_AUDIO, IDS_RS_AUDIODITHERNOISESHAPING, bAudioDitherNoiseShaping);
 	profile.ReadBool(IDS_R_AUDIO, IDS_RS_ENABLEAUDIOTIMESHIFT, bAudioTimeShift);
 	profile.ReadInt(IDS_R_AUDIO, IDS_RS_AUDIOTIMESHIFT, iAudioTimeShift, -600000, 600000);
 	profile.ReadBool(IDS_R_AUDIO, IDS_RS_AUDIOFILTERS, bAudioFilters);
@@ -1415,6 +1420,7 @@ void CAppSettings::LoadSettings(bool bForce/* = false*/)
 	profile.ReadBool(IDS_R_SETTINGS, IDS_RS_SMARTSEEK, fSmartSeek);
 	profile.ReadInt(IDS_R_SETTINGS, IDS_RS_SMARTSEEK_SIZE, iSmartSeekSize, 5, 30);
 	profile.ReadInt(IDS_R_SETTINGS, IDS_RS_SMARTSEEK_VIDEORENDERER, iSmartSeekVR, 0, 1);
+	profile.ReadBool(IDS_R_SETTINGS, IDS_RS_SMARTSEEK_SPRITES, bSmartSeekSprites);
 	profile.ReadBool(IDS_R_SETTINGS, IDS_RS_CHAPTER_MARKER, fChapterMarker);
 	profile.ReadBool(IDS_R_SETTINGS, IDS_RS_USE_FLYBAR, fFlybar);
 	profile.ReadInt(IDS_R_SETTINGS, IDS_RS_PLAYLISTFONTPERCENT, iPlsFontPercent, 100, 200);
@@ -1686,7 +1692,9 @@ void CAppSettings::SaveSettings()
 	profile.WriteBool(IDS_R_AUDIO, IDS_RS_AUDIONORMBOOST, bAudioNormBoost);
 	profile.WriteInt(IDS_R_AUDIO, IDS_RS_AUDIONORMLEVEL, iAudioNormLevel);
 	profile.WriteInt(IDS_R_AUDIO, IDS_RS_AUDIONORMREALEASETIME, iAudioNormRealeaseTime);
+	profile.WriteInt(IDS_R_AUDIO, IDS_RS_AUDIONORMLOOKAHEAD, iAudioNormLookahead);
 	profile.WriteInt(IDS_R_AUDIO, IDS_RS_AUDIOSAMPLEFORMATS, iAudioSampleFormats);
+	profile.WriteBool(IDS_R_AUDIO, IDS_RS_AUDIODITHERNOISESHAPING, bAudioDitherNoiseShaping);
 	profile.WriteBool(IDS_R_AUDIO, IDS_RS_ENABLEAUDIOTIMESHIFT, bAudioTimeShift);
 	profile.WriteInt(IDS_R_AUDIO, IDS_RS_AUDIOTIMESHIFT, iAudioTimeShift);
 	profile.WriteBool(IDS_R_AUDIO, IDS_RS_AUDIOFILTERS, bAudioFilters);
@@ -1751,6 +1759,7 @@ void CAppSettings::SaveSettings()
 	profile.WriteBool(IDS_R_SETTINGS, IDS_RS_SMARTSEEK, fSmartSeek);
 	profile.WriteInt(IDS_R_SETTINGS, IDS_RS_SMARTSEEK_SIZE, iSmartSeekSize);
 	profile.WriteInt(IDS_R_SETTINGS, IDS_RS_SMARTSEEK_VIDEORENDERER, iSmartSeekVR);
+	profile.WriteBool(IDS_R_SETTINGS, IDS_RS_SMARTSEEK_SPRITES, bSmartSeekSprites);
 	profile.WriteBool(IDS_R_SETTINGS, IDS_RS_CHAPTER_MARKER, fChapterMarker);
 	profile.WriteBool(IDS_R_SETTINGS, IDS_RS_USE_FLYBAR, fFlybar);
 	profile.WriteInt(IDS_R_SETTINGS, IDS_RS_PLAYLISTFONTPERCENT, iPlsFontPercent);
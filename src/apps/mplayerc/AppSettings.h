@@ -724,7 +724,9 @@ public:
 	bool			bAudioNormBoost;
 	int				iAudioNormLevel;
 	int				iAudioNormRealeaseTime;
+	int				iAudioNormLookahead;
 	int				iAudioSampleFormats;
+	bool			bAudioDitherNoiseShaping;
 	bool			bAudioTimeShift;
 	int				iAudioTimeShift;
 	bool			bAudioFilters;
@@ -772,6 +774,7 @@ public:
 	bool			fSmartSeek;
 	int				iSmartSeekSize;
 	int				iSmartSeekVR;
+	bool			bSmartSeekSprites;
 	bool			fChapterMarker;
 	bool			fFlybar;
 	int				iPlsFontPercent;
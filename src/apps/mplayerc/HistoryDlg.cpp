@@ -213,6 +213,7 @@ void CHistoryDlg::ClearHistory()
 {
 	if (IDYES == AfxMessageBox(ResStr(IDS_RECENT_FILES_QUESTION), MB_ICONQUESTION | MB_YESNO)) {
 		if (AfxGetMyApp()->m_HistoryFile.Clear()) {
+			AfxGetMyApp()->m_MediaInfoCache.Clear();
 			CComPtr<IApplicationDestinations> pDests;
 			HRESULT hr = pDests.CoCreateInstance(CLSID_ApplicationDestinations, nullptr, CLSCTX_INPROC_SERVER);
 			if (SUCCEEDED(hr)) {
@@ -2787,6 +2787,15 @@ void CMainFrame::OnTimer(UINT_PTR nIDEvent)
 
 								cnt++;
 							}
+
+							if (CComQIPtr<IBufferInfo2> pBI2 = pBF.p) {
+								UINT64 hits, misses, bytes;
+								if (S_OK == pBI2->GetCacheStatus(hits, misses, bytes) && hits + misses) {
+									CString str;
+									str.Format(L"cache: %I64u/%I64u, %I64u MB", hits, hits + misses, bytes / MEGABYTE);
+									sl.push_back(str);
+								}
+							}
 						}
 
 						if (!sl.empty()) {
@@ -4427,6 +4436,13 @@ void CMainFrame::OnFilePostOpenMedia(std::unique_ptr<OpenMediaData>& pOMD)
 		m_wndPlaylistBar.SetCurTime(rtDur);
 	}
 
+	if (s.bSmartSeekSprites && m_pGB_preview && GetPlaybackMode() == PM_FILE && !m_bAudioOnly) {
+		const CStringW path = GetCurFileName();
+		if (!::PathIsURLW(path) && ::PathFileExistsW(path)) {
+			m_PreviewSprites.Start(path, rtDur, GetVideoSize());
+		}
+	}
+
 	m_wndPlaylistBar.SetCurValid(true);
 
 	if (m_youtubeFields.title.IsEmpty()) {
@@ -6278,7 +6294,7 @@ HRESULT CMainFrame::GetOriginalFrame(std::vector<BYTE>& dib, CString& errmsg)
 	return hr;
 }
 
-HRESULT CMainFrame::RenderCurrentSubtitles(BYTE* pData)
+HRESULT CMainFrame::RenderCurrentSubtitles(BYTE* pData, REFERENCE_TIME rtNow/* = INVALID_TIME*/)
 {
 	CheckPointer(pData, E_FAIL);
 	HRESULT hr = S_FALSE;
@@ -6298,8 +6314,10 @@ HRESULT CMainFrame::RenderCurrentSubtitles(BYTE* pData)
 			spdRender.vidrect = {0, 0, width, height};
 			spdRender.bits    = DNew BYTE[spdRender.pitch * spdRender.h];
 
-			REFERENCE_TIME rtNow = 0;
-			m_pMS->GetCurrentPosition(&rtNow);
+			if (rtNow == INVALID_TIME) {
+				rtNow = 0;
+				m_pMS->GetCurrentPosition(&rtNow);
+			}
 
 			CMemSubPic memSubPic(spdRender);
 			memSubPic.ClearDirtyRect();
@@ -8083,6 +8101,10 @@ void CMainFrame::OnPlayPlay()
 			if (m_bIsLiveOnline || FAILED(m_pMS->SetRate(m_PlaybackRate))) {
 				m_PlaybackRate = 1.0;
 			};
+			if (CComQIPtr<IExFilterConfig> pEFC = FindFilter(__uuidof(CMPCVideoDecFilter), m_pGB)) {
+				// the decoded frames are kept only while stepping back, the next step back enables it again
+				pEFC->SetInt("frame_ring_size", 0);
+			}
 			m_pMC->Run();
 		} else if (GetPlaybackMode() == PM_DVD) {
 			if (m_PlaybackRate >= 0.0) {
@@ -8380,6 +8402,13 @@ void CMainFrame::OnPlayFrameStep(UINT nID)
 {
 	m_OSD.EnableShowMessage(false);
 
+	if (nID == ID_PLAY_FRAMESTEP_BACK) {
+		if (CComQIPtr<IExFilterConfig> pEFC = FindFilter(__uuidof(CMPCVideoDecFilter), m_pGB)) {
+			// the decoder keeps the decoded frames, so the next steps back are served without decoding
+			pEFC->SetInt("frame_ring_size", 256);
+		}
+	}
+
 	if (m_pFS && nID == ID_PLAY_FRAMESTEP) {
 		if (GetMediaState() != State_Paused) {
 			SendMessageW(WM_COMMAND, ID_PLAY_PAUSE);
@@ -9283,7 +9312,7 @@ void CMainFrame::OnAutoVolumeControl()
 		CAppSettings& s = AfxGetAppSettings();
 
 		s.bAudioAutoVolumeControl = !s.bAudioAutoVolumeControl;
-		pASF->SetAutoVolumeControl(s.bAudioAutoVolumeControl, s.bAudioNormBoost, s.iAudioNormLevel, s.iAudioNormRealeaseTime);
+		pASF->SetAutoVolumeControl(s.bAudioAutoVolumeControl, s.bAudioNormBoost, s.iAudioNormLevel, s.iAudioNormRealeaseTime, s.iAudioNormLookahead);
 
 		CString osdMessage = ResStr(s.bAudioAutoVolumeControl ? IDS_OSD_AUTOVOLUMECONTROL_ON : IDS_OSD_AUTOVOLUMECONTROL_OFF);
 		m_OSD.DisplayMessage(OSD_TOPLEFT, osdMessage);
@@ -12250,7 +12279,13 @@ HRESULT CMainFrame::PreviewWindowShow(REFERENCE_TIME rtCur2)
 		}
 	}
 	else if (GetPlaybackMode() == PM_FILE && m_pMS_preview) {
-		hr = m_pMS_preview->SetPositions(&rtCur2, AM_SEEKING_AbsolutePositioning, nullptr, AM_SEEKING_NoPositioning);
+		if (m_PreviewSprites.IsReady()) {
+			// the preview graph is not seeked while the sprites are available
+			m_wndPreView.SetSpriteTime(rtCur2);
+		} else {
+			m_wndPreView.SetSpriteTime(INVALID_TIME);
+			hr = m_pMS_preview->SetPositions(&rtCur2, AM_SEEKING_AbsolutePositioning, nullptr, AM_SEEKING_NoPositioning);
+		}
 	}
 
 	if (FAILED(hr)) {
@@ -14476,6 +14511,9 @@ void CMainFrame::CloseMediaPrivate()
 	OnPlayStop();
 	m_OSD.Stop();
 
+	m_PreviewSprites.Stop();
+	m_wndPreView.SetSpriteTime(INVALID_TIME);
+
 	m_pparray.clear();
 	m_ssarray.clear();
 
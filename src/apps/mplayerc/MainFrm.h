@@ -44,6 +44,7 @@
 
 #include "mplayerc.h"
 #include "HistoryFile.h"
+#include "PreviewSprites.h"
 
 #include "DSUtil/DSMPropertyBag.h"
 #include "DSUtil/FontInstaller.h"
@@ -242,6 +243,7 @@ class CMainFrame : public CFrameWnd, public CDropTarget, public CDPI
 	CComQIPtr<IDvdInfo2>            m_pDVDI_preview; // VtX: usually not necessary but may sometimes be necessary.
 	CComPtr<IMFVideoDisplayControl> m_pMFVDC_preview;
 	CComPtr<IAllocatorPresenter>    m_pCAP_preview;
+	CPreviewSprites                 m_PreviewSprites;
 	//
 
 	CComPtr<ICaptureGraphBuilder2>  m_pCGB;
@@ -437,7 +439,7 @@ class CMainFrame : public CFrameWnd, public CDropTarget, public CDPI
 	HRESULT GetDisplayedImage(std::vector<BYTE>& dib, CString& errmsg);
 	HRESULT GetCurrentFrame(std::vector<BYTE>& dib, CString& errmsg);
 	HRESULT GetOriginalFrame(std::vector<BYTE>& dib, CString& errmsg);
-	HRESULT RenderCurrentSubtitles(BYTE* pData);
+	HRESULT RenderCurrentSubtitles(BYTE* pData, REFERENCE_TIME rtNow = INVALID_TIME);
 	bool SaveDIB(LPCWSTR fn, BYTE* pData, long size);
 	bool IsRendererCompatibleWithSaveImage();
 	void SaveImage(LPCWSTR fn, bool displayed);
@@ -0,0 +1,312 @@
+/*
+ * (C) 2023 see Authors.txt
+ *
+ * This file is part of MPC-BE.
+ *
+ * MPC-BE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MPC-BE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "stdafx.h"
+#include "MediaInfoCache.h"
+
+// file format (little-endian):
+// "MPCMI\0" + UINT16 version + UINT32 count, then for each entry:
+// UINT32 path length + path (UTF-16), UINT64 size, UINT64 modification time,
+// INT64 duration, INT32 report language, UINT32 report length + report (UTF-16)
+
+static const char   mic_signature[6] = { 'M', 'P', 'C', 'M', 'I', 0 };
+static const UINT16 mic_version      = 1;
+
+static bool GetFileId(const CStringW& path, UINT64& filesize, UINT64& filetime)
+{
+	WIN32_FILE_ATTRIBUTE_DATA fad;
+	if (!GetFileAttributesExW(path, GetFileExInfoStandard, &fad) || (fad.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+		return false;
+	}
+
+	filesize = ((UINT64)fad.nFileSizeHigh << 32) | fad.nFileSizeLow;
+	filetime = ((UINT64)fad.ftLastWriteTime.dwHighDateTime << 32) | fad.ftLastWriteTime.dwLowDateTime;
+	return true;
+}
+
+template <typename T>
+static bool ReadValue(FILE* pFile, T& value)
+{
+	return fread(&value, sizeof(value), 1, pFile) == 1;
+}
+
+template <typename T>
+static bool WriteValue(FILE* pFile, const T& value)
+{
+	return fwrite(&value, sizeof(value), 1, pFile) == 1;
+}
+
+static bool ReadString(FILE* pFile, CStringW& str, const UINT32 maxlen)
+{
+	UINT32 len = 0;
+	if (!ReadValue(pFile, len) || len > maxlen) {
+		return false;
+	}
+
+	if (len) {
+		const bool ret = fread(str.GetBufferSetLength(len), sizeof(WCHAR), len, pFile) == len;
+		str.ReleaseBufferSetLength(len);
+		return ret;
+	}
+
+	str.Empty();
+	return true;
+}
+
+static bool WriteString(FILE* pFile, const CStringW& str)
+{
+	const UINT32 len = str.GetLength();
+	return WriteValue(pFile, len) && fwrite(str.GetString(), sizeof(WCHAR), len, pFile) == len;
+}
+
+void CMediaInfoCache::SetFilename(const CStringW& filename)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_filename.GetLength() && m_filename.CompareNoCase(filename)) {
+		// the settings location was changed, the cache is saved there
+		Load();
+		_wremove(m_filename);
+		m_bModified = !m_entries.empty();
+	}
+	m_filename = filename;
+}
+
+void CMediaInfoCache::Load()
+{
+	if (m_bLoaded) {
+		return;
+	}
+	m_bLoaded = true;
+
+	if (m_filename.IsEmpty()) {
+		return;
+	}
+
+	FILE* pFile = _wfsopen(m_filename, L"rb", _SH_SECURE);
+	if (!pFile) {
+		return;
+	}
+
+	char signature[sizeof(mic_signature)];
+	UINT16 version = 0;
+	UINT32 count = 0;
+	bool valid = fread(signature, sizeof(signature), 1, pFile) == 1
+		&& !memcmp(signature, mic_signature, sizeof(signature))
+		&& ReadValue(pFile, version) && version == mic_version
+		&& ReadValue(pFile, count);
+
+	// the order in the file is the LRU order
+	for (UINT32 i = 0; valid && i < count; i++) {
+		CStringW path;
+		entry_t entry;
+		INT32 lang = -1;
+		valid = ReadString(pFile, path, MAX_PATH * 8)
+			&& ReadValue(pFile, entry.filesize)
+			&& ReadValue(pFile, entry.filetime)
+			&& ReadValue(pFile, entry.duration)
+			&& ReadValue(pFile, lang)
+			&& ReadString(pFile, entry.report, maximum_size);
+		if (valid) {
+			entry.reportlang = lang;
+			entry.lastuse = ++m_tick;
+			m_size += entry.report.GetLength() * sizeof(WCHAR);
+			m_entries[path] = std::move(entry);
+		}
+	}
+
+	fclose(pFile);
+
+	if (!valid) {
+		DLog(L"CMediaInfoCache::Load() : '%s' is damaged, %u entries loaded", m_filename.GetString(), (unsigned)m_entries.size());
+		m_bModified = true;
+	}
+
+	Evict();
+}
+
+void CMediaInfoCache::Save()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (!m_bModified || m_filename.IsEmpty()) {
+		return;
+	}
+
+	std::vector<std::map<CStringW, entry_t>::const_iterator> entries;
+	entries.reserve(m_entries.size());
+	for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+		entries.emplace_back(it);
+	}
+	std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+		return a->second.lastuse < b->second.lastuse;
+	});
+
+	// write to a temporary name first, so an interrupted save never leaves a truncated file
+	const CStringW tmpname = m_filename + L".tmp";
+	FILE* pFile = _wfsopen(tmpname, L"wb", _SH_SECURE);
+	if (!pFile) {
+		return;
+	}
+
+	bool valid = fwrite(mic_signature, sizeof(mic_signature), 1, pFile) == 1
+		&& WriteValue(pFile, mic_version)
+		&& WriteValue(pFile, (UINT32)entries.size());
+
+	for (size_t i = 0; valid && i < entries.size(); i++) {
+		const auto& [path, entry] = *entries[i];
+		valid = WriteString(pFile, path)
+			&& WriteValue(pFile, entry.filesize)
+			&& WriteValue(pFile, entry.filetime)
+			&& WriteValue(pFile, entry.duration)
+			&& WriteValue(pFile, (INT32)entry.reportlang)
+			&& WriteString(pFile, entry.report);
+	}
+
+	valid = (fclose(pFile) == 0) && valid;
+
+	if (valid && MoveFileExW(tmpname, m_filename, MOVEFILE_REPLACE_EXISTING)) {
+		m_bModified = false;
+	} else {
+		DLog(L"CMediaInfoCache::Save() : failed to write '%s'", m_filename.GetString());
+		_wremove(tmpname);
+	}
+}
+
+void CMediaInfoCache::Evict()
+{
+	while (m_entries.size() > maximum_count || m_size > maximum_size) {
+		auto lru = m_entries.begin();
+		for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+			if (it->second.lastuse < lru->second.lastuse) {
+				lru = it;
+			}
+		}
+
+		m_size -= lru->second.report.GetLength() * sizeof(WCHAR);
+		m_entries.erase(lru);
+		m_bModified = true;
+	}
+}
+
+CMediaInfoCache::entry_t* CMediaInfoCache::Find(const CStringW& path, const bool bCreate)
+{
+	UINT64 filesize, filetime;
+	if (!GetFileId(path, filesize, filetime)) {
+		return nullptr;
+	}
+
+	Load();
+
+	CStringW key(path);
+	key.MakeLower();
+
+	auto it = m_entries.find(key);
+	if (it != m_entries.end() && (it->second.filesize != filesize || it->second.filetime != filetime)) {
+		// the file was changed
+		m_size -= it->second.report.GetLength() * sizeof(WCHAR);
+		m_entries.erase(it);
+		it = m_entries.end();
+		m_bModified = true;
+	}
+
+	if (it == m_entries.end()) {
+		if (!bCreate) {
+			return nullptr;
+		}
+
+		entry_t entry;
+		entry.filesize = filesize;
+		entry.filetime = filetime;
+		it = m_entries.emplace(key, std::move(entry)).first;
+		m_bModified = true;
+	}
+
+	it->second.lastuse = ++m_tick;
+	return &it->second;
+}
+
+bool CMediaInfoCache::GetDuration(const CStringW& path, REFERENCE_TIME& duration)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const auto entry = Find(path, false);
+	if (entry && entry->duration >= 0) {
+		duration = entry->duration;
+		return true;
+	}
+
+	return false;
+}
+
+void CMediaInfoCache::SetDuration(const CStringW& path, const REFERENCE_TIME duration)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (auto entry = Find(path, true)) {
+		entry->duration = std::max<REFERENCE_TIME>(duration, 0);
+		m_bModified = true;
+		Evict();
+	}
+}
+
+bool CMediaInfoCache::GetReport(const CStringW& path, const int lang, CStringW& report)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const auto entry = Find(path, false);
+	if (entry && entry->reportlang == lang) {
+		report = entry->report;
+		return true;
+	}
+
+	return false;
+}
+
+void CMediaInfoCache::SetReport(const CStringW& path, const int lang, const CStringW& report)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (report.GetLength() * sizeof(WCHAR) > maximum_size) {
+		return;
+	}
+
+	if (auto entry = Find(path, true)) {
+		m_size -= entry->report.GetLength() * sizeof(WCHAR);
+		entry->report = report;
+		entry->reportlang = lang;
+		m_size += entry->report.GetLength() * sizeof(WCHAR);
+		m_bModified = true;
+		Evict();
+	}
+}
+
+void CMediaInfoCache::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_entries.clear();
+	m_size = 0;
+	m_bLoaded = true;
+	m_bModified = false;
+	if (m_filename.GetLength()) {
+		_wremove(m_filename);
+	}
+}
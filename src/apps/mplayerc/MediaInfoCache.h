@@ -0,0 +1,69 @@
+/*
+ * (C) 2023 see Authors.txt
+ *
+ * This file is part of MPC-BE.
+ *
+ * MPC-BE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MPC-BE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <map>
+#include <mutex>
+
+// Results of MediaInfo parsing for local files.
+// An entry is valid as long as the size and the modification time of the file
+// are unchanged. The entries are kept in a binary file in the settings folder.
+
+class CMediaInfoCache
+{
+public:
+	constexpr static size_t maximum_count = 10000;
+	constexpr static size_t maximum_size  = 32 * 1024 * 1024; // text of the reports
+
+private:
+	struct entry_t {
+		UINT64 filesize = 0;
+		UINT64 filetime = 0;
+		UINT64 lastuse  = 0;
+		REFERENCE_TIME duration = -1; // -1 - not parsed
+		int reportlang = -1;          // -1 - no report
+		CStringW report;
+	};
+
+	std::mutex m_mutex;
+	CStringW m_filename;
+	std::map<CStringW, entry_t> m_entries; // key - lowercase path
+	size_t m_size    = 0;
+	UINT64 m_tick    = 0;
+	bool m_bLoaded   = false;
+	bool m_bModified = false;
+
+	void Load();
+	void Evict();
+	entry_t* Find(const CStringW& path, const bool bCreate);
+
+public:
+	void SetFilename(const CStringW& filename);
+	void Save();
+
+	bool GetDuration(const CStringW& path, REFERENCE_TIME& duration);
+	void SetDuration(const CStringW& path, const REFERENCE_TIME duration);
+
+	bool GetReport(const CStringW& path, const int lang, CStringW& report);
+	void SetReport(const CStringW& path, const int lang, const CStringW& report);
+
+	void Clear();
+};
@@ -107,18 +107,27 @@ BOOL CPPageFileMediaInfo::OnInitDialog()
 {
 	__super::OnInitDialog();
 
-	MediaInfo MI;
-
-	MI.Option(L"ParseSpeed", L"0.5");
-	MI.Option(L"Language", mi_get_lang_file());
-	MI.Option(L"LegacyStreamDisplay", L"1");
-	MI.Option(L"Complete");
-	MI.Open(m_fn.GetString());
-	MI_Text = MI.Inform().c_str();
-	MI.Close();
-
-	if (!MI_Text.Find(L"Unable to load")) {
-		MI_Text.Empty();
+	auto& cache = AfxGetMyApp()->m_MediaInfoCache;
+	const int lang = AfxGetAppSettings().iLanguage;
+
+	if (!cache.GetReport(m_fn, lang, MI_Text)) {
+		MediaInfo MI;
+
+		MI.Option(L"ParseSpeed", L"0.5");
+		MI.Option(L"Language", mi_get_lang_file());
+		MI.Option(L"LegacyStreamDisplay", L"1");
+		MI.Option(L"Complete");
+		MI.Open(m_fn.GetString());
+		MI_Text = MI.Inform().c_str();
+		MI.Close();
+
+		if (!MI_Text.Find(L"Unable to load")) {
+			MI_Text.Empty();
+		}
+
+		if (MI_Text.GetLength()) {
+			cache.SetReport(m_fn, lang, MI_Text);
+		}
 	}
 
 	LOGFONT lf = {};
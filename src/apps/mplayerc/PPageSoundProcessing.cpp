@@ -287,8 +287,9 @@ BOOL CPPageSoundProcessing::OnApply()
 		pASF->SetBassRedirect(s.bAudioBassRedirect);
 		pASF->SetLevels(s.dAudioCenter_dB, s.dAudioSurround_dB);
 		pASF->SetAudioGain(s.dAudioGain_dB);
-		pASF->SetAutoVolumeControl(s.bAudioAutoVolumeControl, s.bAudioNormBoost, s.iAudioNormLevel, s.iAudioNormRealeaseTime);
+		pASF->SetAutoVolumeControl(s.bAudioAutoVolumeControl, s.bAudioNormBoost, s.iAudioNormLevel, s.iAudioNormRealeaseTime, s.iAudioNormLookahead);
 		pASF->SetOutputFormats(s.iAudioSampleFormats);
+		pASF->SetDitherNoiseShaping(s.bAudioDitherNoiseShaping);
 		pASF->SetAudioTimeShift(s.bAudioTimeShift ? 10000i64*s.iAudioTimeShift : 0);
 		if (s.bAudioFilters) {
 			pASF->SetAudioFilter1(s.strAudioFilter1);
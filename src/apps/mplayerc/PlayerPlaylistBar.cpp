@@ -525,26 +525,24 @@ void CPlaylistItem::AutoLoadFiles()
 
 POSITION CPlaylist::Append(CPlaylistItem& item, const bool bParseDuration)
 {
-	if (bParseDuration && !item.m_duration && !item.m_fns.empty()) {
-		const auto& fn = item.m_fns.front().GetName();
-		if (!::PathIsURLW(item.m_fns.front()) && ::PathFileExistsW(item.m_fns.front())) {
-			MediaInfo MI;
-			MI.Option(L"ParseSpeed", L"0");
-			if (MI.Open(fn.GetString())) {
-				CString duration = MI.Get(Stream_General, 0, L"Duration", Info_Text, Info_Name).c_str();
-				if (!duration.IsEmpty() && StrToInt64(duration.GetString(), item.m_duration)) {
-					item.m_duration *= 10000LL;
-				}
-			}
-		}
+	if (bParseDuration && !item.m_duration && !item.m_fns.empty()
+			&& !::PathIsURLW(item.m_fns.front())) {
+		m_durationRequests.emplace_back(item.m_id, item.m_fns.front().GetName());
 	}
 
 	return AddTail(item);
 }
 
+void CPlaylist::DropDurationRequests()
+{
+	m_durationRequests.clear();
+	m_durationGeneration = ++m_globalDurationGeneration;
+}
+
 bool CPlaylist::RemoveAll()
 {
 	__super::RemoveAll();
+	DropDurationRequests();
 	bool bWasPlaying = (m_pos != nullptr);
 	m_pos = nullptr;
 	return bWasPlaying;
@@ -806,6 +804,15 @@ CPlayerPlaylistBar::CPlayerPlaylistBar(CMainFrame* pMainFrame)
 
 CPlayerPlaylistBar::~CPlayerPlaylistBar()
 {
+	{
+		std::unique_lock<std::mutex> lock(m_mutexDuration);
+		m_bDurationStop = true;
+	}
+	m_cvDuration.notify_all();
+	for (auto& thread : m_durationThreads) {
+		thread.join();
+	}
+
 	TEnsureVisible(m_nCurPlayListIndex); // save selected tab visible
 	SavePlaylist();
 	TSaveSettings();
@@ -1922,6 +1929,126 @@ void CPlayerPlaylistBar::Refresh()
 {
 	SetupList();
 	ResizeListColumn();
+	StartDurationRequests();
+}
+
+void CPlayerPlaylistBar::StartDurationRequests()
+{
+	std::unique_lock<std::mutex> lock(m_mutexDuration);
+
+	for (const auto& pl : m_pls) {
+		for (const auto& [id, fn] : pl->m_durationRequests) {
+			m_durationQueue.push_back({ pl, pl->m_durationGeneration, id, fn });
+		}
+		pl->m_durationRequests.clear();
+	}
+
+	if (m_durationQueue.empty()) {
+		return;
+	}
+
+	if (m_durationThreads.empty()) {
+		// MediaInfo mostly waits for the disk, a few threads are enough
+		const unsigned count = std::clamp(std::thread::hardware_concurrency(), 1u, 4u);
+		for (unsigned i = 0; i < count; i++) {
+			m_durationThreads.emplace_back(&CPlayerPlaylistBar::ThreadDuration, this);
+		}
+	}
+
+	m_cvDuration.notify_all();
+}
+
+void CPlayerPlaylistBar::CancelDurationRequests(CPlaylist* pl/* = nullptr*/)
+{
+	std::unique_lock<std::mutex> lock(m_mutexDuration);
+
+	if (pl) {
+		m_durationQueue.erase(std::remove_if(m_durationQueue.begin(), m_durationQueue.end(),
+			[pl](const duration_request_t& request) { return request.pl == pl; }), m_durationQueue.end());
+		pl->DropDurationRequests();
+	} else {
+		m_durationQueue.clear();
+		for (const auto& playlist : m_pls) {
+			playlist->DropDurationRequests();
+		}
+	}
+}
+
+void CPlayerPlaylistBar::ThreadDuration()
+{
+	for (;;) {
+		duration_request_t request;
+		{
+			std::unique_lock<std::mutex> lock(m_mutexDuration);
+			m_cvDuration.wait(lock, [&] { return m_bDurationStop || !m_durationQueue.empty(); });
+			if (m_bDurationStop) {
+				break;
+			}
+
+			request = std::move(m_durationQueue.front());
+			m_durationQueue.pop_front();
+		}
+
+		auto& cache = AfxGetMyApp()->m_MediaInfoCache;
+
+		REFERENCE_TIME rtDuration = 0;
+		if (::PathFileExistsW(request.fn) && !cache.GetDuration(request.fn, rtDuration)) {
+			MediaInfo MI;
+			MI.Option(L"ParseSpeed", L"0");
+			if (MI.Open(request.fn.GetString())) {
+				CString duration = MI.Get(Stream_General, 0, L"Duration", Info_Text, Info_Name).c_str();
+				if (!duration.IsEmpty() && StrToInt64(duration.GetString(), rtDuration)) {
+					rtDuration *= 10000LL;
+				}
+				cache.SetDuration(request.fn, rtDuration);
+			}
+		}
+
+		if (rtDuration > 0) {
+			std::unique_lock<std::mutex> lock(m_mutexDuration);
+			// one message for all results collected until the window handles it
+			if (m_durationResults.empty()) {
+				::PostMessageW(m_hWnd, WM_PLAYLIST_DURATION, 0, 0);
+			}
+			m_durationResults.push_back({ request.generation, request.id, rtDuration });
+		}
+	}
+}
+
+LRESULT CPlayerPlaylistBar::OnPlaylistDuration(WPARAM wParam, LPARAM lParam)
+{
+	std::vector<duration_result_t> results;
+	{
+		std::unique_lock<std::mutex> lock(m_mutexDuration);
+		results.swap(m_durationResults);
+	}
+
+	for (const auto& pl : m_pls) {
+		// the results for items that were dropped after the request have an older generation
+		std::map<UINT, REFERENCE_TIME> durations;
+		for (const auto& result : results) {
+			if (result.generation == pl->m_durationGeneration) {
+				durations.emplace(result.id, result.rtDuration);
+			}
+		}
+
+		const bool bCurrent = (pl == &curPlayList);
+
+		POSITION pos = pl->GetHeadPosition();
+		for (int i = 0; pos && !durations.empty(); i++) {
+			CPlaylistItem& pli = pl->GetNext(pos);
+			const auto it = durations.find(pli.m_id);
+			if (it != durations.cend()) {
+				pli.m_duration = it->second;
+				if (bCurrent && i < m_list.GetItemCount()) {
+					m_list.SetItemText(i, COL_TIME, pli.GetLabel(1));
+				}
+				durations.erase(it);
+			}
+		}
+	}
+
+	return 0;
 }
 
 bool CPlayerPlaylistBar::Empty()
@@ -1930,6 +2057,8 @@ bool CPlayerPlaylistBar::Empty()
 		return false;
 	}
 
+	CancelDurationRequests(&curPlayList);
+
 	bool bWasPlaying = curPlayList.RemoveAll();
 	m_list.DeleteAllItems();
 	SavePlaylist();
@@ -2602,6 +2731,7 @@ BEGIN_MESSAGE_MAP(CPlayerPlaylistBar, CSizingControlBarG)
 	ON_NOTIFY(LVN_ENDLABELEDITW, IDC_PLAYLIST, OnLvnEndlabeleditList)
 	ON_WM_MEASUREITEM()
 	ON_WM_SETFOCUS()
+	ON_MESSAGE(WM_PLAYLIST_DURATION, OnPlaylistDuration)
 END_MESSAGE_MAP()
 
 // CPlayerPlaylistBar message handlers
@@ -3815,6 +3945,9 @@ void CPlayerPlaylistBar::OnContextMenu(CWnd* /*pWnd*/, CPoint p)
 			break;
 		case M_DURATION:
 			s.bPlaylistDetermineDuration = !s.bPlaylistDetermineDuration;
+			if (!s.bPlaylistDetermineDuration) {
+				CancelDurationRequests();
+			}
 			break;
 	}
 }
@@ -4249,6 +4382,7 @@ void CPlayerPlaylistBar::TOnMenu(bool bUnderCursor)
 					}
 
 					m_tabs.erase(m_tabs.begin() + m_nCurPlayListIndex);
+					CancelDurationRequests(m_pls[m_nCurPlayListIndex]);
 					SAFE_DELETE(m_pls[m_nCurPlayListIndex]);
 					m_pls.erase(m_pls.begin() + m_nCurPlayListIndex);
 
@@ -1,6 +1,6 @@
 /*
  * (C) 2003-2006 Gabest
- * (C) 2006-2021 see Authors.txt
+ * (C) 2006-2023 see Authors.txt
  *
  * This file is part of MPC-BE.
  *
@@ -21,6 +21,10 @@
 
 #pragma once
 
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "PlayerBar.h"
 #include "PlayerListCtrl.h"
 #include "controls/ColorEdit.h"
@@ -146,6 +150,8 @@ public:
 
 class CPlaylist : public CList<CPlaylistItem>
 {
+	static inline UINT m_globalDurationGeneration = 0;
+
 protected:
 	POSITION m_pos = nullptr;
 
@@ -155,6 +161,13 @@ public:
 
 	POSITION Append(CPlaylistItem& item, const bool bParseDuration);
 
+	// items waiting for CPlayerPlaylistBar to determine their duration: id, file name
+	std::list<std::pair<UINT, CString>> m_durationRequests;
+	// unique among all playlists, changes when the items are dropped, older duration results are ignored then
+	UINT m_durationGeneration = ++m_globalDurationGeneration;
+
+	void DropDurationRequests();
+
 	bool RemoveAll();
 	bool RemoveAt(POSITION pos);
 
@@ -337,6 +350,29 @@ private:
 	unsigned m_nCurPlaybackListId = 0;
 	void CloseMedia() const;
 
+	// duration is determined by MediaInfo in the background
+	struct duration_request_t {
+		const CPlaylist* pl;
+		UINT generation;
+		UINT id;
+		CString fn;
+	};
+	struct duration_result_t {
+		UINT generation;
+		UINT id;
+		REFERENCE_TIME rtDuration;
+	};
+	std::mutex m_mutexDuration;
+	std::condition_variable m_cvDuration;
+	std::deque<duration_request_t> m_durationQueue;
+	std::vector<duration_result_t> m_durationResults;
+	std::vector<std::thread> m_durationThreads;
+	bool m_bDurationStop = false;
+
+	void ThreadDuration();
+	void StartDurationRequests();
+	void CancelDurationRequests(CPlaylist* pl = nullptr);
+
 	COLORREF m_crBkBar;
 
 	COLORREF m_crBN;
@@ -479,6 +515,7 @@ public:
 	afx_msg void OnLvnEndlabeleditList(NMHDR* pNMHDR, LRESULT* pResult);
 	afx_msg void OnMeasureItem(int nIDCtl, LPMEASUREITEMSTRUCT lpMeasureItemStruct);
 	afx_msg void OnSetFocus(CWnd* pOldWnd);
+	afx_msg LRESULT OnPlaylistDuration(WPARAM wParam, LPARAM lParam);
 
 	virtual void Invalidate() { m_list.Invalidate(); }
 
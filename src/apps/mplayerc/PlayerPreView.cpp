@@ -64,6 +64,23 @@ HWND CPreView::GetVideoHWND()
 	return m_view.GetSafeHwnd();
 }
 
+void CPreView::SetSpriteTime(const REFERENCE_TIME rt)
+{
+	if (rt == m_rtSprite) {
+		return;
+	}
+
+	const bool bShowVideo = (rt == INVALID_TIME);
+	if (bShowVideo != (m_rtSprite == INVALID_TIME) && m_view.GetSafeHwnd()) {
+		m_view.ShowWindow(bShowVideo ? SW_SHOWNOACTIVATE : SW_HIDE);
+	}
+	m_rtSprite = rt;
+
+	if (!bShowVideo && GetSafeHwnd()) {
+		InvalidateRect(m_videorect, FALSE);
+	}
+}
+
 IMPLEMENT_DYNAMIC(CPreView, CWnd)
 
 BEGIN_MESSAGE_MAP(CPreView, CWnd)
@@ -185,7 +202,9 @@ void CPreView::OnPaint()
 	mdc.SetTextColor(m_crText);
 	mdc.DrawTextW(m_tooltipstr, m_tooltipstr.GetLength(), &rtime, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
 
-	dc.ExcludeClipRect(m_videorect);
+	if (m_rtSprite == INVALID_TIME || !m_pMainFrame->m_PreviewSprites.Draw(&mdc, m_videorect, m_rtSprite)) {
+		dc.ExcludeClipRect(m_videorect);
+	}
 	dc.BitBlt(0, 0, w, h, &mdc, 0, 0, SRCCOPY);
 
 	mdc.SelectObject(pOldBm);
@@ -40,6 +40,8 @@ private:
 	CWnd	m_view;
 	CRect	m_videorect;
 
+	REFERENCE_TIME m_rtSprite = INVALID_TIME; // INVALID_TIME - the video of the preview graph is shown
+
 	CFont m_font;
 
 	struct t_color {
@@ -60,6 +62,8 @@ public:
 	void GetVideoRect(LPRECT lpRect);
 	HWND GetVideoHWND();
 
+	void SetSpriteTime(const REFERENCE_TIME rt);
+
 	void SetWindowSize();
 
 	void ScaleFont();
@@ -0,0 +1,392 @@
+/*
+ * (C) 2023 see Authors.txt
+ *
+ * This file is part of MPC-BE.
+ *
+ * MPC-BE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MPC-BE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "stdafx.h"
+#include "DSUtil/ResampleRGB32.h"
+#include "ThumbnailExtractor.h"
+#include "PreviewSprites.h"
+
+// file format (little-endian):
+// "MPCSP\0" + UINT16 version + INT32 width + INT32 height + UINT32 count,
+// then count * INT64 time and count * width * height * 4 bytes of the sprites
+
+static const char   sp_signature[6] = { 'M', 'P', 'C', 'S', 'P', 0 };
+static const UINT16 sp_version      = 1;
+
+static const size_t sp_header_size = sizeof(sp_signature) + sizeof(UINT16) + sizeof(INT32) * 2 + sizeof(UINT32);
+
+CPreviewSprites::~CPreviewSprites()
+{
+	Stop();
+}
+
+CStringW CPreviewSprites::GetCacheFolder()
+{
+	WCHAR lpszTempPath[MAX_PATH] = {};
+	if (!GetTempPathW(MAX_PATH, lpszTempPath)) {
+		return L"";
+	}
+
+	CStringW path(lpszTempPath);
+	path.Append(L"mpc-be_sprites\\");
+	if (!CreateDirectoryW(path, nullptr) && GetLastError() != ERROR_ALREADY_EXISTS) {
+		DLog(L"CPreviewSprites::GetCacheFolder() : can't create '%s'", path.GetString());
+		return L"";
+	}
+
+	return path;
+}
+
+CStringW CPreviewSprites::GetCacheFileName(const CStringW& path)
+{
+	WIN32_FILE_ATTRIBUTE_DATA fad;
+	if (!GetFileAttributesExW(path, GetFileExInfoStandard, &fad) || (fad.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+		return L"";
+	}
+
+	const CStringW folder = GetCacheFolder();
+	if (folder.IsEmpty()) {
+		return L"";
+	}
+
+	// FNV-1a
+	UINT64 hash = 0xcbf29ce484222325ull;
+	auto Hash = [&hash](const void* data, const size_t size) {
+		for (size_t i = 0; i < size; i++) {
+			hash = (hash ^ ((const BYTE*)data)[i]) * 0x100000001b3ull;
+		}
+	};
+
+	CStringW key(path);
+	key.MakeLower();
+	Hash(key.GetString(), key.GetLength() * sizeof(WCHAR));
+	Hash(&fad.nFileSizeHigh, sizeof(fad.nFileSizeHigh));
+	Hash(&fad.nFileSizeLow, sizeof(fad.nFileSizeLow));
+	Hash(&fad.ftLastWriteTime, sizeof(fad.ftLastWriteTime));
+
+	CStringW filename;
+	filename.Format(L"%s%016I64x.sprites", folder.GetString(), hash);
+	return filename;
+}
+
+void CPreviewSprites::EvictFiles(const CStringW& folder)
+{
+	struct file_t {
+		CStringW name;
+		UINT64 size;
+		UINT64 lastuse;
+	};
+	std::vector<file_t> files;
+	UINT64 size = 0;
+
+	WIN32_FIND_DATAW fd;
+	HANDLE hFind = FindFirstFileW(folder + L"*.sprites", &fd);
+	if (hFind != INVALID_HANDLE_VALUE) {
+		do {
+			if (!(fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+				const UINT64 filesize = ((UINT64)fd.nFileSizeHigh << 32) | fd.nFileSizeLow;
+				const UINT64 lastuse = ((UINT64)fd.ftLastWriteTime.dwHighDateTime << 32) | fd.ftLastWriteTime.dwLowDateTime;
+				files.emplace_back(file_t{ fd.cFileName, filesize, lastuse });
+				size += filesize;
+			}
+		} while (FindNextFileW(hFind, &fd));
+		FindClose(hFind);
+	}
+
+	std::sort(files.begin(), files.end(), [](const file_t& a, const file_t& b) {
+		return a.lastuse < b.lastuse;
+	});
+
+	for (const auto& file : files) {
+		if (size <= maximum_size) {
+			break;
+		}
+		DeleteFileW(folder + file.name);
+		size -= file.size;
+	}
+}
+
+bool CPreviewSprites::Load(const CStringW& filename)
+{
+	HANDLE hFile = CreateFileW(filename, GENERIC_READ | FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	std::vector<BYTE> data;
+	LARGE_INTEGER filesize = {};
+	if (GetFileSizeEx(hFile, &filesize) && filesize.QuadPart >= (LONGLONG)sp_header_size && filesize.QuadPart <= (LONGLONG)maximum_size) {
+		data.resize((size_t)filesize.QuadPart);
+		DWORD dwSizeRead = 0;
+		if (!ReadFile(hFile, data.data(), (DWORD)data.size(), &dwSizeRead, nullptr) || dwSizeRead != data.size()) {
+			data.clear();
+		}
+	}
+
+	if (data.size()) {
+		// the write time keeps the LRU order of the cache files
+		FILETIME ft;
+		GetSystemTimeAsFileTime(&ft);
+		SetFileTime(hFile, nullptr, nullptr, &ft);
+	}
+	CloseHandle(hFile);
+
+	const BYTE* p = data.data();
+	auto Read = [&](void* dst, const size_t size) {
+		memcpy(dst, p, size);
+		p += size;
+	};
+
+	char signature[sizeof(sp_signature)] = {};
+	UINT16 version = 0;
+	INT32 width = 0, height = 0;
+	UINT32 count = 0;
+	if (data.size()) {
+		Read(signature, sizeof(signature));
+		Read(&version, sizeof(version));
+		Read(&width, sizeof(width));
+		Read(&height, sizeof(height));
+		Read(&count, sizeof(count));
+	}
+
+	if (memcmp(signature, sp_signature, sizeof(signature)) || version != sp_version
+			|| width != sprite_width || height <= 0 || height > sprite_width * 4 || !count || count > maximum_count
+			|| data.size() != sp_header_size + count * (sizeof(INT64) + (size_t)width * height * 4)) {
+		DLog(L"CPreviewSprites::Load() : '%s' is invalid", filename.GetString());
+		DeleteFileW(filename);
+		return false;
+	}
+
+	std::vector<REFERENCE_TIME> times(count);
+	Read(times.data(), count * sizeof(INT64));
+	std::vector<BYTE> bits(p, data.data() + data.size());
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_size.SetSize(width, height);
+	m_times.swap(times);
+	m_bits.swap(bits);
+	m_bReady = true;
+
+	return true;
+}
+
+void CPreviewSprites::Save(const CStringW& filename)
+{
+	std::vector<BYTE> data;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		const INT32 width  = m_size.cx;
+		const INT32 height = m_size.cy;
+		const UINT32 count = (UINT32)m_times.size();
+
+		data.resize(sp_header_size + count * sizeof(INT64) + m_bits.size());
+		BYTE* p = data.data();
+		auto Write = [&](const void* src, const size_t size) {
+			memcpy(p, src, size);
+			p += size;
+		};
+
+		Write(sp_signature, sizeof(sp_signature));
+		Write(&sp_version, sizeof(sp_version));
+		Write(&width, sizeof(width));
+		Write(&height, sizeof(height));
+		Write(&count, sizeof(count));
+		Write(m_times.data(), count * sizeof(INT64));
+		Write(m_bits.data(), m_bits.size());
+	}
+
+	// write to a temporary name first, so an interrupted save never leaves a truncated file
+	const CStringW tmpname = filename + L".tmp";
+	HANDLE hFile = CreateFileW(tmpname, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		return;
+	}
+
+	DWORD dwSizeWritten = 0;
+	const BOOL bWritten = WriteFile(hFile, data.data(), (DWORD)data.size(), &dwSizeWritten, nullptr) && dwSizeWritten == data.size();
+	CloseHandle(hFile);
+
+	if (!bWritten || !MoveFileExW(tmpname, filename, MOVEFILE_REPLACE_EXISTING)) {
+		DLog(L"CPreviewSprites::Save() : failed to write '%s'", filename.GetString());
+		DeleteFileW(tmpname);
+	}
+}
+
+void CPreviewSprites::ThreadGenerate(const CStringW path, const REFERENCE_TIME duration, const CSize size)
+{
+	const CStringW filename = GetCacheFileName(path);
+	if (filename.GetLength() && Load(filename)) {
+		DLog(L"CPreviewSprites::ThreadGenerate() : sprites of '%s' loaded from the cache", path.GetString());
+		return;
+	}
+
+	const LONGLONG llStart = GetPerfCounter();
+
+	// one sprite per 2 seconds at most, the extractor takes the nearest keyframes
+	const size_t count = (size_t)std::clamp<REFERENCE_TIME>(duration / (2 * UNITS), 1, maximum_count);
+	std::vector<CThumbnailExtractor::frame_t> frames(count);
+	for (size_t i = 0; i < count; i++) {
+		frames[i].rtTarget = duration * (2 * i + 1) / (2 * count);
+	}
+
+	// two workers are enough here, the playback must not suffer
+	CThumbnailExtractor extractor(path, 2);
+	extractor.SetFrameCallback([&size](CThumbnailExtractor::frame_t& frame) {
+		const BITMAPINFOHEADER* bih = (BITMAPINFOHEADER*)frame.dib.data();
+
+		std::vector<BYTE> sprite(size.cx * size.cy * 4);
+		CResampleRGB32 Resample;
+		HRESULT hr = Resample.SetParameters(size.cx, size.cy, bih->biWidth, abs(bih->biHeight), CResampleRGB32::FILTER_BILINEAR, false);
+		if (S_OK == hr) {
+			hr = Resample.Process(sprite.data(), (const BYTE*)(bih + 1));
+		}
+
+		if (S_OK == hr) {
+			frame.dib.swap(sprite);
+		} else {
+			frame.dib.clear();
+		}
+	});
+
+	std::atomic_int progress = 0;
+	if (FAILED(extractor.Extract(frames, m_bAbort, progress)) || m_bAbort) {
+		return;
+	}
+
+	std::vector<REFERENCE_TIME> times;
+	std::vector<BYTE> bits;
+	times.reserve(count);
+	bits.reserve(count * size.cx * size.cy * 4);
+
+	// the frames are sorted by the target time, neighbouring targets can get the same keyframe
+	for (const auto& frame : frames) {
+		if (frame.dib.empty()) {
+			continue;
+		}
+		const REFERENCE_TIME rt = (frame.rtFrame != INVALID_TIME) ? frame.rtFrame : frame.rtTarget;
+		if (times.size() && rt <= times.back()) {
+			continue;
+		}
+		times.emplace_back(rt);
+		bits.insert(bits.end(), frame.dib.cbegin(), frame.dib.cend());
+	}
+
+	const size_t nSprites = times.size();
+	if (!nSprites) {
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_size = size;
+		m_times.swap(times);
+		m_bits.swap(bits);
+		m_bReady = true;
+	}
+
+	DLog(L"CPreviewSprites::ThreadGenerate() : %u sprites of '%s' generated in %I64d ms",
+		 (unsigned)nSprites, path.GetString(), (GetPerfCounter() - llStart) / 10000);
+
+	if (filename.GetLength()) {
+		Save(filename);
+		EvictFiles(GetCacheFolder());
+	}
+}
+
+void CPreviewSprites::Start(LPCWSTR path, const REFERENCE_TIME duration, const CSize& arsize)
+{
+	Stop();
+
+	if (duration <= 0 || arsize.cx <= 0 || arsize.cy <= 0) {
+		return;
+	}
+
+	const CSize size(sprite_width, std::clamp(MulDiv(sprite_width, arsize.cy, arsize.cx) & ~1, 2, sprite_width * 4));
+
+	m_bAbort = false;
+	m_thread = std::thread([this, path = CStringW(path), duration, size] {
+		if (SUCCEEDED(CoInitialize(nullptr))) {
+			ThreadGenerate(path, duration, size);
+			CoUninitialize();
+		}
+	});
+}
+
+void CPreviewSprites::Stop()
+{
+	if (m_thread.joinable()) {
+		m_bAbort = true;
+		m_thread.join();
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_times.clear();
+	m_bits.clear();
+	m_bReady = false;
+}
+
+bool CPreviewSprites::IsReady()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	return m_bReady;
+}
+
+bool CPreviewSprites::Draw(CDC* pDC, const CRect& rect, const REFERENCE_TIME rt)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	if (!m_bReady || rect.IsRectEmpty()) {
+		return false;
+	}
+
+	// the nearest sprite
+	auto it = std::lower_bound(m_times.cbegin(), m_times.cend(), rt);
+	if (it == m_times.cend() || (it != m_times.cbegin() && rt - *(it - 1) < *it - rt)) {
+		--it;
+	}
+	const size_t index = it - m_times.cbegin();
+
+	// keep the aspect ratio
+	CRect r(rect);
+	const int h = MulDiv(r.Width(), m_size.cy, m_size.cx);
+	if (h <= r.Height()) {
+		r.DeflateRect(0, (r.Height() - h) / 2);
+	} else {
+		r.DeflateRect((r.Width() - MulDiv(r.Height(), m_size.cx, m_size.cy)) / 2, 0);
+	}
+
+	pDC->FillSolidRect(rect, RGB(0, 0, 0));
+
+	BITMAPINFO bmi = {};
+	bmi.bmiHeader.biSize        = sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth       = m_size.cx;
+	bmi.bmiHeader.biHeight      = m_size.cy;
+	bmi.bmiHeader.biPlanes      = 1;
+	bmi.bmiHeader.biBitCount    = 32;
+	bmi.bmiHeader.biCompression = BI_RGB;
+
+	const int oldMode = pDC->SetStretchBltMode(HALFTONE);
+	StretchDIBits(pDC->GetSafeHdc(), r.left, r.top, r.Width(), r.Height(), 0, 0, m_size.cx, m_size.cy,
+				  m_bits.data() + index * m_size.cx * m_size.cy * 4, &bmi, DIB_RGB_COLORS, SRCCOPY);
+	pDC->SetStretchBltMode(oldMode);
+
+	return true;
+}
@@ -0,0 +1,66 @@
+/*
+ * (C) 2023 see Authors.txt
+ *
+ * This file is part of MPC-BE.
+ *
+ * MPC-BE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MPC-BE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <mutex>
+#include <thread>
+#include "mpc_defines.h"
+
+// Small keyframe pictures of the whole file for the SmartSeek preview.
+// They are generated in the background with CThumbnailExtractor and stored
+// in the temporary folder under a name made of the path, size and modification
+// time of the file, so the next opening of the same file gets them at once.
+
+class CPreviewSprites
+{
+public:
+	constexpr static int    sprite_width  = 160;
+	constexpr static size_t maximum_count = 100;
+	constexpr static UINT64 maximum_size  = 256ull * MEGABYTE; // of the cache folder
+
+private:
+	std::mutex       m_mutex;
+	std::thread      m_thread;
+	std::atomic_bool m_bAbort = false;
+
+	CSize                       m_size;  // of a sprite
+	std::vector<REFERENCE_TIME> m_times; // sorted
+	std::vector<BYTE>           m_bits;  // bottom-up RGB32 sprites one after another
+	bool                        m_bReady = false;
+
+	static CStringW GetCacheFolder();
+	static CStringW GetCacheFileName(const CStringW& path);
+	static void EvictFiles(const CStringW& folder);
+
+	bool Load(const CStringW& filename);
+	void Save(const CStringW& filename);
+
+	void ThreadGenerate(const CStringW path, const REFERENCE_TIME duration, const CSize size);
+
+public:
+	~CPreviewSprites();
+
+	void Start(LPCWSTR path, const REFERENCE_TIME duration, const CSize& arsize);
+	void Stop();
+
+	bool IsReady();
+	bool Draw(CDC* pDC, const CRect& rect, const REFERENCE_TIME rt);
+};
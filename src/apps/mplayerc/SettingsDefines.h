@@ -86,7 +86,9 @@
 #define IDS_RS_AUDIONORMBOOST				L"NormBoost"
 #define IDS_RS_AUDIONORMLEVEL				L"NormLevel"
 #define IDS_RS_AUDIONORMREALEASETIME		L"NormRealeaseTime"
+#define IDS_RS_AUDIONORMLOOKAHEAD			L"NormLookahead"
 #define IDS_RS_AUDIOSAMPLEFORMATS			L"SampleFormats"
+#define IDS_RS_AUDIODITHERNOISESHAPING		L"DitherNoiseShaping"
 #define IDS_RS_ENABLEAUDIOTIMESHIFT			L"EnableTimeShift"
 #define IDS_RS_AUDIOTIMESHIFT				L"TimeShift"
 #define IDS_RS_AUDIOFILTERS					L"AudioFilters"
@@ -325,6 +327,7 @@
 #define IDS_RS_SMARTSEEK					L"UseSmartSeek"
 #define IDS_RS_SMARTSEEK_SIZE				L"SmartSeekSize"
 #define IDS_RS_SMARTSEEK_VIDEORENDERER		L"SmartSeekVideoRenderer"
+#define IDS_RS_SMARTSEEK_SPRITES			L"SmartSeekSprites"
 #define IDS_RS_CHAPTER_MARKER				L"ChapterMarker"
 #define IDS_RS_FILENAMEONSEEKBAR			L"FileNameOnSeekBar"
 
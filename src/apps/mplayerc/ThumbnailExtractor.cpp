@@ -0,0 +1,346 @@
+/*
+ * (C) 2023 see Authors.txt
+ *
+ * This file is part of MPC-BE.
+ *
+ * MPC-BE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MPC-BE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "stdafx.h"
+#include <thread>
+#include <FilterInterfaces.h>
+#include <IKeyFrameInfo.h>
+#include "FGManager.h"
+#include "ThumbnailExtractor.h"
+
+#define FRAME_TIMEOUT 10000 // ms
+
+//
+// CThumbnailSink - keeps the first sample after each seek
+//
+
+class __declspec(uuid("904BBABD-D62E-4AA2-AA58-F5A9729A7C7E"))
+	CThumbnailSink : public CBaseRenderer
+{
+	CCritSec          m_csFrame;
+	CAMEvent          m_evFrame;
+	CMediaType        m_mtFrame;
+	std::vector<BYTE> m_dib;
+	REFERENCE_TIME    m_rtFrame = INVALID_TIME;
+
+protected:
+	HRESULT CheckMediaType(const CMediaType* pmt) override;
+	HRESULT SetMediaType(const CMediaType* pmt) override;
+	HRESULT DoRenderSample(IMediaSample* pSample) override { return S_OK; }
+	void OnReceiveFirstSample(IMediaSample* pSample) override;
+
+public:
+	CThumbnailSink(HRESULT* phr)
+		: CBaseRenderer(__uuidof(this), L"Thumbnail Sink", nullptr, phr)
+		, m_evFrame(TRUE) {}
+
+	HRESULT BeginFlush() override;
+	HRESULT EndOfStream() override;
+
+	void Reset();
+	bool WaitFrame(const std::atomic_bool& bAbort);
+	REFERENCE_TIME GetFrame(std::vector<BYTE>& dib);
+};
+
+HRESULT CThumbnailSink::CheckMediaType(const CMediaType* pmt)
+{
+	BITMAPINFOHEADER bih;
+	if (pmt->majortype == MEDIATYPE_Video && pmt->subtype == MEDIASUBTYPE_RGB32
+			&& (pmt->formattype == FORMAT_VideoInfo || pmt->formattype == FORMAT_VideoInfo2)
+			&& ExtractBIH(pmt, &bih) && bih.biBitCount == 32) {
+		return S_OK;
+	}
+
+	return E_FAIL;
+}
+
+HRESULT CThumbnailSink::SetMediaType(const CMediaType* pmt)
+{
+	CAutoLock cAutoLock(&m_csFrame);
+	m_mtFrame = *pmt;
+
+	return __super::SetMediaType(pmt);
+}
+
+void CThumbnailSink::OnReceiveFirstSample(IMediaSample* pSample)
+{
+	CAutoLock cAutoLock(&m_csFrame);
+
+	AM_MEDIA_TYPE* pmt = nullptr;
+	if (S_OK == pSample->GetMediaType(&pmt) && pmt) {
+		m_mtFrame = *pmt;
+		DeleteMediaType(pmt);
+	}
+
+	BITMAPINFOHEADER bih;
+	BYTE* pData = nullptr;
+	if (!ExtractBIH(&m_mtFrame, &bih) || bih.biWidth <= 0 || FAILED(pSample->GetPointer(&pData))) {
+		m_evFrame.Set();
+		return;
+	}
+
+	// VIDEOINFOHEADER and VIDEOINFOHEADER2 both start with rcSource
+	const RECT& rcSource = ((VIDEOINFOHEADER*)m_mtFrame.pbFormat)->rcSource;
+	const int stride = bih.biWidth * 4;
+	const int lines  = abs(bih.biHeight);
+
+	CRect r(0, 0, bih.biWidth, lines);
+	if (!IsRectEmpty(&rcSource)) {
+		r.IntersectRect(r, &rcSource);
+	}
+
+	if (r.IsRectEmpty() || pSample->GetActualDataLength() < stride * lines) {
+		m_evFrame.Set();
+		return;
+	}
+
+	m_dib.resize(sizeof(BITMAPINFOHEADER) + r.Width() * r.Height() * 4);
+
+	BITMAPINFOHEADER* pbih = (BITMAPINFOHEADER*)m_dib.data();
+	memset(pbih, 0, sizeof(BITMAPINFOHEADER));
+	pbih->biSize        = sizeof(BITMAPINFOHEADER);
+	pbih->biWidth       = r.Width();
+	pbih->biHeight      = r.Height();
+	pbih->biPlanes      = 1;
+	pbih->biBitCount    = 32;
+	pbih->biCompression = BI_RGB;
+	pbih->biSizeImage   = DIBSIZE(*pbih);
+
+	// the output is always bottom-up
+	BYTE* dst = (BYTE*)(pbih + 1);
+	for (int y = r.bottom - 1; y >= r.top; y--, dst += r.Width() * 4) {
+		const int line = bih.biHeight > 0 ? lines - 1 - y : y;
+		memcpy(dst, pData + line * stride + r.left * 4, r.Width() * 4);
+	}
+
+	m_rtFrame = INVALID_TIME;
+	REFERENCE_TIME rtStart, rtStop;
+	if (SUCCEEDED(pSample->GetTime(&rtStart, &rtStop))) {
+		m_rtFrame = rtStart + m_pInputPin->CurrentStartTime();
+	}
+
+	m_evFrame.Set();
+}
+
+HRESULT CThumbnailSink::BeginFlush()
+{
+	Reset();
+
+	return __super::BeginFlush();
+}
+
+HRESULT CThumbnailSink::EndOfStream()
+{
+	// nothing more will come, don't let the waiting run into the timeout
+	m_evFrame.Set();
+
+	return __super::EndOfStream();
+}
+
+void CThumbnailSink::Reset()
+{
+	CAutoLock cAutoLock(&m_csFrame);
+
+	m_evFrame.Reset();
+	m_dib.clear();
+	m_rtFrame = INVALID_TIME;
+}
+
+bool CThumbnailSink::WaitFrame(const std::atomic_bool& bAbort)
+{
+	for (int i = 0; i < FRAME_TIMEOUT / 50; i++) {
+		if (bAbort) {
+			return false;
+		}
+		if (m_evFrame.Wait(50)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+REFERENCE_TIME CThumbnailSink::GetFrame(std::vector<BYTE>& dib)
+{
+	CAutoLock cAutoLock(&m_csFrame);
+
+	dib = m_dib;
+	return m_rtFrame;
+}
+
+//
+// CThumbnailExtractor
+//
+
+static REFERENCE_TIME GetNearestKeyFrame(const std::vector<REFERENCE_TIME>& kfs, const REFERENCE_TIME rtTarget)
+{
+	if (kfs.empty()) {
+		return rtTarget;
+	}
+
+	auto upper = std::upper_bound(kfs.cbegin(), kfs.cend(), rtTarget);
+	if (upper == kfs.cbegin()) {
+		return *upper;
+	}
+	if (upper == kfs.cend()) {
+		return kfs.back();
+	}
+
+	const REFERENCE_TIME rtLower = *(upper - 1);
+	return (rtTarget - rtLower < *upper - rtTarget) ? rtLower : *upper;
+}
+
+CThumbnailExtractor::CThumbnailExtractor(LPCWSTR path, const unsigned maxThreads/* = max_threads*/)
+	: m_path(path)
+	, m_maxThreads(std::clamp(maxThreads, 1u, max_threads))
+{
+}
+
+HRESULT CThumbnailExtractor::ExtractRange(frame_t* frames, const size_t count, const std::atomic_bool& bAbort, std::atomic_int& progress)
+{
+	HRESULT hr = S_OK;
+
+	CComPtr<IGraphBuilder2> pGB = DNew CFGManagerCustom(L"CFGManagerThumbnails", nullptr, nullptr, true);
+	CComPtr<CThumbnailSink> pSink = DNew CThumbnailSink(&hr);
+	if (FAILED(hr)
+			|| FAILED(hr = pGB->AddFilter(pSink, L"Thumbnail Sink"))
+			|| FAILED(hr = pGB->RenderFile(m_path, nullptr))) {
+		return hr;
+	}
+
+	if (!pSink->GetPin(0)->IsConnected()) {
+		return VFW_E_CANNOT_RENDER;
+	}
+
+	CComQIPtr<IMediaControl> pMC = pGB.p;
+	CComQIPtr<IMediaSeeking> pMS = pGB.p;
+	if (!pMC || !pMS) {
+		return E_NOINTERFACE;
+	}
+
+	std::vector<REFERENCE_TIME> kfs;
+	BeginEnumFilters(pGB, pEF, pBF) {
+		if (CComQIPtr<IExFilterConfig> pEFC = pBF.p) {
+			pEFC->SetBool("keyframes_only", true);
+		}
+
+		CComQIPtr<IKeyFrameInfo> pKFI = pBF.p;
+		UINT nKFs = 0;
+		if (kfs.empty() && pKFI && S_OK == pKFI->GetKeyFrameCount(nKFs) && nKFs > 1) {
+			UINT k = nKFs;
+			kfs.resize(k);
+			if (FAILED(pKFI->GetKeyFrames(&TIME_FORMAT_MEDIA_TIME, kfs.data(), k)) || k != nKFs) {
+				kfs.clear();
+			}
+		}
+	}
+	EndEnumFilters;
+
+	if (!std::is_sorted(kfs.cbegin(), kfs.cend())) {
+		kfs.clear();
+	}
+
+	if (FAILED(hr = pMC->Pause())) {
+		return hr;
+	}
+
+	OAFilterState fs = State_Stopped;
+	while ((hr = pMC->GetState(50, &fs)) == VFW_S_STATE_INTERMEDIATE && !bAbort);
+
+	REFERENCE_TIME rtPos = INVALID_TIME;
+	REFERENCE_TIME rtFrame = INVALID_TIME;
+	std::vector<BYTE> dib;
+
+	for (size_t i = 0; i < count && !bAbort; i++) {
+		auto& frame = frames[i];
+
+		// the neighbouring targets can share the same keyframe
+		const REFERENCE_TIME rtSeek = GetNearestKeyFrame(kfs, frame.rtTarget);
+		if (rtSeek != rtPos) {
+			rtPos = rtSeek;
+			pSink->Reset();
+
+			REFERENCE_TIME rt = rtSeek;
+			if (SUCCEEDED(pMS->SetPositions(&rt, AM_SEEKING_AbsolutePositioning, nullptr, AM_SEEKING_NoPositioning))
+					&& pSink->WaitFrame(bAbort)) {
+				rtFrame = pSink->GetFrame(dib);
+			} else {
+				DLog(L"CThumbnailExtractor::ExtractRange() : no frame at %s", ReftimeToString(rtSeek).GetString());
+				dib.clear();
+			}
+		}
+
+		if (dib.size()) {
+			frame.dib = dib;
+			frame.rtFrame = rtFrame;
+			if (m_fnFrame) {
+				m_fnFrame(frame);
+			}
+		}
+		progress++;
+	}
+
+	pMC->Stop();
+
+	return bAbort ? E_ABORT : S_OK;
+}
+
+HRESULT CThumbnailExtractor::Extract(std::vector<frame_t>& frames, const std::atomic_bool& bAbort, std::atomic_int& progress)
+{
+	if (frames.empty()) {
+		return S_FALSE;
+	}
+
+	// each worker gets a contiguous part of the targets, so it seeks only forward
+	const unsigned nThreads = std::clamp(std::thread::hardware_concurrency() / 2, 1u, std::min(m_maxThreads, (unsigned)frames.size()));
+	const size_t part = frames.size() / nThreads;
+	const size_t rest = frames.size() % nThreads;
+
+	std::vector<HRESULT> results(nThreads, E_FAIL);
+	std::vector<std::thread> threads;
+
+	size_t first = 0;
+	for (unsigned i = 0; i < nThreads; i++) {
+		const size_t count = part + (i < rest ? 1 : 0);
+		threads.emplace_back([&, i, first, count] {
+			if (SUCCEEDED(CoInitialize(nullptr))) {
+				results[i] = ExtractRange(&frames[first], count, bAbort, progress);
+				CoUninitialize();
+			}
+		});
+		first += count;
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	if (bAbort) {
+		return E_ABORT;
+	}
+
+	for (const auto& frame : frames) {
+		if (frame.dib.size()) {
+			return S_OK;
+		}
+	}
+
+	return FAILED(results.front()) ? results.front() : E_FAIL;
+}
@@ -0,0 +1,58 @@
+/*
+ * (C) 2023 see Authors.txt
+ *
+ * This file is part of MPC-BE.
+ *
+ * MPC-BE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MPC-BE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <functional>
+
+// Extracts the video frames of a local file without touching the playback graph.
+// Every worker opens the file in its own graph (splitter and software decoder
+// in preview mode, no video renderer) and decodes only the keyframes nearest
+// to its part of the targets.
+
+class CThumbnailExtractor
+{
+public:
+	struct frame_t {
+		REFERENCE_TIME rtTarget = 0;
+		REFERENCE_TIME rtFrame  = INVALID_TIME; // time of the extracted keyframe
+		std::vector<BYTE> dib;                  // BITMAPINFOHEADER + bottom-up RGB32 bits, empty on failure
+	};
+
+	constexpr static unsigned max_threads = 4;
+
+	// called on a worker thread for each extracted frame, can replace the frame data
+	using FrameCallback = std::function<void(frame_t& frame)>;
+
+private:
+	CStringW m_path;
+	unsigned m_maxThreads;
+	FrameCallback m_fnFrame;
+
+	HRESULT ExtractRange(frame_t* frames, const size_t count, const std::atomic_bool& bAbort, std::atomic_int& progress);
+
+public:
+	CThumbnailExtractor(LPCWSTR path, const unsigned maxThreads = max_threads);
+
+	void SetFrameCallback(FrameCallback fnFrame) { m_fnFrame = fnFrame; }
+
+	// frames must be sorted by rtTarget, progress is incremented for each processed frame
+	HRESULT Extract(std::vector<frame_t>& frames, const std::atomic_bool& bAbort, std::atomic_int& progress);
+};
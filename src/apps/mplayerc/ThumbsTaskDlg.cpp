@@ -24,6 +24,7 @@
 #include "MainFrm.h"
 #include "DSUtil/Filehandle.h"
 #include "DSUtil/ResampleRGB32.h"
+#include "ThumbnailExtractor.h"
 
 #include "ThumbsTaskDlg.h"
 
@@ -155,27 +156,74 @@ void CThumbsTaskDlg::SaveThumbnails(LPCWSTR thumbpath)
 		return;
 	}
 
+	const int pics = cols * rows;
+
+	// the keyframes of a local file are decoded in separate graphs, the playback is not disturbed then
+	std::vector<CThumbnailExtractor::frame_t> frames;
+	const CStringW filepath = m_pMainFrm->GetCurFileName();
+	if (m_pMainFrm->GetPlaybackMode() == PM_FILE && !::PathIsURLW(filepath) && ::PathFileExistsW(filepath)) {
+		frames.resize(pics);
+		for (int i = 0; i < pics; i++) {
+			frames[i].rtTarget = duration * (i + 1) / (pics + 1);
+		}
+
+		const REFERENCE_TIME rtStart = GetPerfCounter();
+		CThumbnailExtractor extractor(filepath);
+		const HRESULT hr = extractor.Extract(frames, m_bAbort, m_iProgress);
+		if (m_bAbort) {
+			return;
+		}
+
+		const auto extracted = std::count_if(frames.cbegin(), frames.cend(), [](const auto& frame) { return !frame.dib.empty(); });
+		DLog(L"CThumbsTaskDlg::SaveThumbnails() : %d of %d frames of '%s' extracted in %I64d ms, hr = 0x%08x",
+			 (int)extracted, pics, filepath.GetString(), (GetPerfCounter() - rtStart) / 10000, hr);
+
+		if (FAILED(hr)) {
+			// use the playback graph
+			frames.clear();
+			m_iProgress = 1;
+		}
+	}
+
 	CCritSec csSubLock;
 	RECT bbox;
 	CResampleRGB32 Resample;
 
-	for (int i = 1, pics = cols * rows; i <= pics; i++) {
-		const REFERENCE_TIME rt = duration * i / (pics + 1);
-		const CStringW strTime = ReftimeToString2(rt);
+	for (int i = 1; i <= pics; i++) {
+		REFERENCE_TIME rt = duration * i / (pics + 1);
+		REFERENCE_TIME rtSubtitles = INVALID_TIME;
+		std::vector<BYTE> dib_frame;
+		HRESULT hr = S_OK;
 
-		m_pMainFrm->SeekTo(rt, false);
+		if (frames.size() && frames[i - 1].dib.size()) {
+			dib_frame.swap(frames[i - 1].dib);
+			if (frames[i - 1].rtFrame != INVALID_TIME) {
+				rt = frames[i - 1].rtFrame;
+			}
+			rtSubtitles = rt;
+		} else {
+			m_pMainFrm->SeekTo(rt, false);
+
+			m_pMainFrm->m_bFrameSteppingActive = true;
+			// Number of steps you need to do more than one for some decoders.
+			// TODO - maybe need to find another way to get correct frame ???
+			hr = m_pMainFrm->m_pFS->Step(2, nullptr);
+			while (m_pMainFrm->m_bFrameSteppingActive) {
+				if (m_bAbort) {
+					return;
+				}
+				Sleep(50);
+			}
 
-		m_pMainFrm->m_bFrameSteppingActive = true;
-		// Number of steps you need to do more than one for some decoders.
-		// TODO - maybe need to find another way to get correct frame ???
-		HRESULT hr = m_pMainFrm->m_pFS->Step(2, nullptr);
-		while (m_pMainFrm->m_bFrameSteppingActive) {
-			if (m_bAbort) {
+			CStringW errmsg;
+			if (S_OK != m_pMainFrm->GetOriginalFrame(dib_frame, errmsg)) {
+				m_iProgress = PROGRESS_E_FAIL;
 				return;
 			}
-			Sleep(50);
 		}
 
+		const CStringW strTime = ReftimeToString2(rt);
+
 		const int col = (i - 1) % cols;
 		const int row = (i - 1) / cols;
 
@@ -199,13 +247,6 @@ void CThumbsTaskDlg::SaveThumbnails(LPCWSTR thumbpath)
 
 		rts.Render(spd, 0, 25, bbox);
 
-		std::vector<BYTE> dib_frame;
-		CStringW errmsg;
-		if (S_OK != m_pMainFrm->GetOriginalFrame(dib_frame, errmsg)) {
-			m_iProgress = PROGRESS_E_FAIL;
-			return;
-		}
-
 		const BITMAPINFO* bi = (BITMAPINFO*)dib_frame.data();
 		if (bi->bmiHeader.biBitCount != 32) {
 			m_ErrorMsg.Format(ResStr(IDS_MAINFRM_57), bi->bmiHeader.biBitCount);
@@ -213,7 +254,7 @@ void CThumbsTaskDlg::SaveThumbnails(LPCWSTR thumbpath)
 			return;
 		}
 
-		m_pMainFrm->RenderCurrentSubtitles(dib_frame.data());
+		m_pMainFrm->RenderCurrentSubtitles(dib_frame.data(), rtSubtitles);
 
 		hr = Resample.SetParameters(
 			thumbsize.cx, thumbsize.cy,
@@ -238,7 +279,9 @@ void CThumbsTaskDlg::SaveThumbnails(LPCWSTR thumbpath)
 
 		rts.Render(spd, 10000, 25, bbox);
 
-		m_iProgress++; // make one more thumbnail
+		if (frames.empty()) {
+			m_iProgress++; // make one more thumbnail, the extracted frames are already counted
+		}
 		if (m_bAbort) {
 			return;
 		}
@@ -268,7 +311,6 @@ void CThumbsTaskDlg::SaveThumbnails(LPCWSTR thumbpath)
 		CStringW filesize;
 
 		if (filename.IsEmpty()) {
-			const CStringW filepath = m_pMainFrm->GetCurFileName();
 			filename = GetFileOnly(filepath);
 
 			WIN32_FIND_DATAW wfd;
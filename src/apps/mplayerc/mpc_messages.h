@@ -35,6 +35,7 @@ enum : UINT {
 	WM_TUNER_NEW_CHANNEL,
 	WM_POSTOPEN,
 	WM_SAVESETTINGS,
+	WM_PLAYLIST_DURATION,
 
 	SETPAGEFOCUS            = WM_APP + 252,
 	EDIT_BUTTON_LEFTCLICKED = WM_APP + 842,
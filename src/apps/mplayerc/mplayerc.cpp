@@ -48,6 +48,7 @@ extern "C" {
 
 #define MPC_HISTORY_FILENAME "history.mpc_lst"
 #define MPC_FAVORITES_FILENAME "favorites.mpc_lst"
+#define MPC_MEDIAINFO_FILENAME "mediainfo.cache"
 
 const LanguageResource CMPlayerCApp::languageResources[] = {
 	{ID_LANGUAGE_ARMENIAN,				1067,	L"Armenian",				L"hy",	L"arm"},
@@ -285,6 +286,7 @@ bool CMPlayerCApp::ChangeSettingsLocation(const SettingsLocation newSetLocation)
 
 		m_HistoryFile.SetFilename(newpath + MPC_HISTORY_FILENAME);
 		m_FavoritesFile.SetFilename(newpath + MPC_FAVORITES_FILENAME);
+		m_MediaInfoCache.SetFilename(newpath + MPC_MEDIAINFO_FILENAME);
 
 		if (::PathFileExistsW(oldHistoryPath)) {
 			// moving history file
@@ -1037,6 +1039,7 @@ BOOL CMPlayerCApp::InitInstance()
 	}
 	m_HistoryFile.SetMaxCount(m_s.nHistoryEntriesMax);
 	m_FavoritesFile.SetFilename(appSavePath + MPC_FAVORITES_FILENAME);
+	m_MediaInfoCache.SetFilename(appSavePath + MPC_MEDIAINFO_FILENAME);
 
 	AfxEnableControlContainer();
 
@@ -1311,6 +1314,8 @@ int CMPlayerCApp::ExitInstance()
 		}
 	}
 
+	m_MediaInfoCache.Save();
+
 	OleUninitialize();
 
 	return CWinApp::ExitInstance();
@@ -29,6 +29,7 @@
 #include <atlsync.h>
 #include "DSUtil/Profile.h"
 #include "HistoryFile.h"
+#include "MediaInfoCache.h"
 #include "AppSettings.h"
 
 #include <mutex>
@@ -64,6 +65,7 @@ public:
 
 	CHistoryFile m_HistoryFile;
 	CFavoritesFile m_FavoritesFile;
+	CMediaInfoCache m_MediaInfoCache;
 
 	CString m_AudioRendererDisplayName_CL;
 
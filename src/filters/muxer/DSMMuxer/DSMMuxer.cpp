@@ -64,6 +64,9 @@ CFilterApp theApp;
 
 #endif
 
+#define PART_INTERVAL_SIZE   (4 * MEGABYTE)
+#define PART_INTERVAL_COUNT  1000
+
 template<typename T> static T myabs(T n)
 {
 	return n >= 0 ? n : -n;
@@ -172,6 +175,8 @@ void CDSMMuxerFilter::MuxInit()
 {
 	m_sps.clear();
 	m_isps.clear();
+	m_ispsPart.clear();
+	m_fpPart = 0;
 	m_rtPrevSyncPoint = INVALID_TIME;
 }
 
@@ -315,6 +320,15 @@ void CDSMMuxerFilter::MuxPacket(IBitStream* pBS, const MuxerPacket* pPacket)
 
 	ASSERT(!pPacket->IsSyncPoint() || pPacket->IsTimeValid());
 
+	// an interrupted or still growing file can be seeked by the partial indexes,
+	// each of them points to the previous one, so they are found from the end of the file
+	const __int64 fp = pBS->GetPos();
+	if (fp - m_fpPart >= PART_INTERVAL_SIZE || m_ispsPart.size() >= PART_INTERVAL_COUNT) {
+		MuxSyncPoints(pBS, m_ispsPart, m_fpPart ? fp - m_fpPart : 0);
+		m_ispsPart.clear();
+		m_fpPart = fp;
+	}
+
 	REFERENCE_TIME rtTimeStamp = INVALID_TIME, rtDuration = 0;
 	int iTimeStamp = 0, iDuration = 0;
 
@@ -348,16 +362,23 @@ void CDSMMuxerFilter::MuxFooter(IBitStream* pBS)
 {
 	// syncpoints
 
+	for (const auto& isp : m_isps) {
+		TRACE(L"sp[%d]: %I64d %I64x\n", isp.id, isp.rt, isp.fp);
+	}
+
+	MuxSyncPoints(pBS, m_isps);
+}
+
+void CDSMMuxerFilter::MuxSyncPoints(IBitStream* pBS, const std::list<IndexedSyncPoint>& isps, const __int64 fpBack/* = -1*/)
+{
 	int len = 0;
 	REFERENCE_TIME rtPrev = 0, rt;
 	UINT64 fpPrev = 0, fp;
 
-	std::vector<IndexedSyncPoint> isps;
-	isps.reserve(m_isps.size());
-
-	for (const auto& isp : m_isps) {
-		TRACE(L"sp[%d]: %I64d %I64x\n", isp.id, isp.rt, isp.fp);
+	std::vector<IndexedSyncPoint> isps2;
+	isps2.reserve(isps.size());
 
+	for (const auto& isp : isps) {
 		rt = isp.rt - rtPrev;
 		rtPrev = isp.rt;
 		fp = isp.fp - fpPrev;
@@ -366,14 +387,24 @@ void CDSMMuxerFilter::MuxFooter(IBitStream* pBS)
 		IndexedSyncPoint isp2;
 		isp2.fp = fp;
 		isp2.rt = rt;
-		isps.push_back(isp2);
+		isps2.push_back(isp2);
 
 		len += 1 + GetByteLength(myabs(rt)) + GetByteLength(fp); // flags + rt + fp
 	}
 
-	MuxPacketHeader(pBS, DSMP_SYNCPOINTS, len);
+	if (fpBack >= 0) {
+		// partial index, starts with the distance back to the previous one (0 - there is none)
+		const int iBack = GetByteLength(fpBack, 1);
 
-	for (const auto& isp : isps) {
+		MuxPacketHeader(pBS, DSMP_SYNCPOINTS_PART, 1 + iBack + len);
+		pBS->BitWrite(iBack - 1, 3);
+		pBS->BitWrite(0, 5); // reserved
+		pBS->BitWrite(fpBack, iBack << 3);
+	} else {
+		MuxPacketHeader(pBS, DSMP_SYNCPOINTS, len);
+	}
+
+	for (const auto& isp : isps2) {
 		int irt = GetByteLength(myabs(isp.rt));
 		int ifp = GetByteLength(isp.fp);
 
@@ -419,6 +450,7 @@ void CDSMMuxerFilter::IndexSyncPoint(const MuxerPacket* p, __int64 fp)
 			isp.rtfp = head.rtStart;
 			isp.fp = head.fp;
 			m_isps.push_back(isp);
+			m_ispsPart.push_back(isp);
 		}
 	}
 
@@ -1,6 +1,6 @@
 /*
  * (C) 2003-2006 Gabest
- * (C) 2006-2014 see Authors.txt
+ * (C) 2006-2023 see Authors.txt
  *
  * This file is part of MPC-BE.
  *
@@ -43,12 +43,15 @@ class __declspec(uuid("C6590B76-587E-4082-9125-680D0693A97B"))
 	};
 	std::list<SyncPoint> m_sps;
 	std::list<IndexedSyncPoint> m_isps;
+	std::list<IndexedSyncPoint> m_ispsPart; // not written yet in a partial index
+	__int64 m_fpPart = 0;                   // position of the last partial index
 	REFERENCE_TIME m_rtPrevSyncPoint;
 	void IndexSyncPoint(const MuxerPacket* p, __int64 fp);
 
 	void MuxPacketHeader(IBitStream* pBS, dsmp_t type, UINT64 len);
 	void MuxFileInfo(IBitStream* pBS);
 	void MuxStreamInfo(IBitStream* pBS, CBaseMuxerInputPin* pPin);
+	void MuxSyncPoints(IBitStream* pBS, const std::list<IndexedSyncPoint>& isps, const __int64 fpBack = -1);
 
 protected:
 	void MuxInit();
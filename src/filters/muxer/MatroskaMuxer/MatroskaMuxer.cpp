@@ -22,6 +22,7 @@
 #include "stdafx.h"
 #include <MMReg.h>
 #include "MatroskaMuxer.h"
+#include "WriteBehindStream.h"
 #include "DSUtil/DSUtil.h"
 #include <moreuuids.h>
 
@@ -354,9 +355,9 @@ ULONGLONG SetStreamPosition(IStream* pStream, ULONGLONG seekpos)
 #pragma warning(disable: 4702)
 DWORD CMatroskaMuxerFilter::ThreadProc()
 {
-	CComQIPtr<IStream> pStream;
+	CComQIPtr<IStream> pOutputStream;
 
-	if (!m_pOutput || !(pStream = m_pOutput->GetConnected())) {
+	if (!m_pOutput || !(pOutputStream = m_pOutput->GetConnected())) {
 		for (;;) {
 			DWORD cmd = GetRequest();
 			if (cmd == CMD_EXIT) {
@@ -369,6 +370,9 @@ DWORD CMatroskaMuxerFilter::ThreadProc()
 		}
 	}
 
+	// the elements are written in small pieces, collect them and write on another thread
+	CComPtr<IStream> pStream = DNew CWriteBehindStream(pOutputStream);
+
 	REFERENCE_TIME rtDur = 0;
 	GetDuration(&rtDur);
 
@@ -692,6 +696,8 @@ DWORD CMatroskaMuxerFilter::ThreadProc()
 
 				// TODO: write some tags
 
+				pStream->Commit(STGC_DEFAULT);
+
 				m_pOutput->DeliverEndOfStream();
 
 				break;
@@ -0,0 +1,289 @@
+/*
+ * (C) 2023 see Authors.txt
+ *
+ * This file is part of MPC-BE.
+ *
+ * MPC-BE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MPC-BE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "stdafx.h"
+#include "DSUtil/DSUtil.h"
+#include "WriteBehindStream.h"
+
+CWriteBehindStream::CWriteBehindStream(IStream* pStream)
+	: CUnknown(L"CWriteBehindStream", nullptr)
+	, m_pStream(pStream)
+{
+	ULARGE_INTEGER pos = {};
+	LARGE_INTEGER move = {};
+	if (SUCCEEDED(m_pStream->Seek(move, STREAM_SEEK_CUR, &pos))) {
+		m_pos = pos.QuadPart;
+	}
+
+	m_startTime = GetPerfCounter();
+	m_thread = std::thread([this] { ThreadWrite(); });
+}
+
+CWriteBehindStream::~CWriteBehindStream()
+{
+	Flush();
+
+	{
+		std::unique_lock lock(m_mutex);
+		m_bExit = true;
+	}
+	m_cvQueue.notify_all();
+	m_thread.join();
+
+	if (m_buffer.data) {
+		_aligned_free(m_buffer.data);
+	}
+	for (auto& data : m_free) {
+		_aligned_free(data);
+	}
+
+#if DEBUG_OR_LOG
+	const ULONGLONG totalTime = GetPerfCounter() - m_startTime;
+	DLog(L"CWriteBehindStream : %I64u MB written in %I64u ms (%I64u ms of writing, %I64u MB/s), max queue depth %Iu of %Iu",
+		m_nBytes / MEGABYTE, totalTime / 10000, m_writeTime / 10000,
+		m_writeTime ? m_nBytes * 10000000 / m_writeTime / MEGABYTE : 0,
+		m_nMaxQueueDepth, max_queue_depth);
+#endif
+}
+
+STDMETHODIMP CWriteBehindStream::NonDelegatingQueryInterface(REFIID riid, void** ppv)
+{
+	CheckPointer(ppv, E_POINTER);
+
+	return
+		QI(IStream)
+		QI(ISequentialStream)
+		__super::NonDelegatingQueryInterface(riid, ppv);
+}
+
+void CWriteBehindStream::ThreadWrite()
+{
+	for (;;) {
+		buffer_t buffer;
+		{
+			std::unique_lock lock(m_mutex);
+			m_cvQueue.wait(lock, [&] { return m_bExit || !m_queue.empty(); });
+			if (m_queue.empty()) {
+				return;
+			}
+
+			buffer = m_queue.front();
+			m_queue.pop_front();
+			m_bWriting = true;
+		}
+
+		const ULONGLONG start = GetPerfCounter();
+
+		// the underlying position is only moved here or after a flush
+		ULARGE_INTEGER pos = {};
+		LARGE_INTEGER move = {};
+		HRESULT hr = m_pStream->Seek(move, STREAM_SEEK_CUR, &pos);
+		if (SUCCEEDED(hr) && pos.QuadPart != buffer.pos) {
+			move.QuadPart = buffer.pos;
+			hr = m_pStream->Seek(move, STREAM_SEEK_SET, nullptr);
+		}
+		if (SUCCEEDED(hr)) {
+			hr = m_pStream->Write(buffer.data, buffer.size, nullptr);
+		}
+
+		const ULONGLONG time = GetPerfCounter() - start;
+
+		{
+			std::unique_lock lock(m_mutex);
+			if (FAILED(hr) && SUCCEEDED(m_hrWrite)) {
+				DLog(L"CWriteBehindStream::ThreadWrite() : writing of %u bytes at %I64u failed (0x%08x)", buffer.size, buffer.pos, hr);
+				m_hrWrite = hr;
+			}
+			m_nBytes += buffer.size;
+			m_writeTime += time;
+
+			m_free.push_back(buffer.data);
+			m_bWriting = false;
+		}
+		m_cvDone.notify_all();
+	}
+}
+
+BYTE* CWriteBehindStream::AllocBuffer()
+{
+	{
+		std::unique_lock lock(m_mutex);
+		if (!m_free.empty()) {
+			BYTE* data = m_free.back();
+			m_free.pop_back();
+			return data;
+		}
+	}
+
+	return (BYTE*)_aligned_malloc(buffer_size, buffer_align);
+}
+
+void CWriteBehindStream::QueueBuffer()
+{
+	if (!m_buffer.size) {
+		return;
+	}
+
+	{
+		std::unique_lock lock(m_mutex);
+		// the muxing waits here only if the target is slower than the input all the time
+		m_cvDone.wait(lock, [&] { return m_queue.size() < max_queue_depth; });
+
+		m_queue.push_back(m_buffer);
+		m_nMaxQueueDepth = std::max(m_nMaxQueueDepth, m_queue.size());
+	}
+	m_cvQueue.notify_one();
+
+	m_buffer = {};
+}
+
+HRESULT CWriteBehindStream::Flush()
+{
+	QueueBuffer();
+
+	std::unique_lock lock(m_mutex);
+	m_cvDone.wait(lock, [&] { return m_queue.empty() && !m_bWriting; });
+
+	return m_hrWrite;
+}
+
+// ISequentialStream
+
+STDMETHODIMP CWriteBehindStream::Read(void* pv, ULONG cb, ULONG* pcbRead)
+{
+	HRESULT hr = Flush();
+	if (FAILED(hr)) {
+		return hr;
+	}
+
+	hr = m_pStream->Read(pv, cb, pcbRead);
+	if (SUCCEEDED(hr)) {
+		ULARGE_INTEGER pos = {};
+		LARGE_INTEGER move = {};
+		m_pStream->Seek(move, STREAM_SEEK_CUR, &pos);
+		m_pos = pos.QuadPart;
+	}
+
+	return hr;
+}
+
+STDMETHODIMP CWriteBehindStream::Write(const void* pv, ULONG cb, ULONG* pcbWritten)
+{
+	CheckPointer(pv, STG_E_INVALIDPOINTER);
+
+	const BYTE* src = (const BYTE*)pv;
+	ULONG written = 0;
+
+	while (written < cb) {
+		if (!m_buffer.data) {
+			m_buffer.data = AllocBuffer();
+			if (!m_buffer.data) {
+				break;
+			}
+		}
+		if (!m_buffer.size) {
+			m_buffer.pos = m_pos;
+		}
+
+		const ULONG size = std::min(cb - written, buffer_size - m_buffer.size);
+		memcpy(m_buffer.data + m_buffer.size, src + written, size);
+		m_buffer.size += size;
+		written += size;
+		m_pos += size;
+
+		if (m_buffer.size == buffer_size) {
+			QueueBuffer();
+		}
+	}
+
+	if (pcbWritten) {
+		*pcbWritten = written;
+	}
+
+	if (written < cb) {
+		return E_OUTOFMEMORY;
+	}
+
+	// an earlier failure of the thread is reported on the next write
+	return m_hrWrite;
+}
+
+// IStream
+
+STDMETHODIMP CWriteBehindStream::Seek(LARGE_INTEGER dlibMove, DWORD dwOrigin, ULARGE_INTEGER* plibNewPosition)
+{
+	// the muxer asks for the current position all the time, that doesn't need a flush
+	if ((dwOrigin == STREAM_SEEK_CUR && dlibMove.QuadPart == 0)
+			|| (dwOrigin == STREAM_SEEK_SET && (ULONGLONG)dlibMove.QuadPart == m_pos)) {
+		if (plibNewPosition) {
+			plibNewPosition->QuadPart = m_pos;
+		}
+		return S_OK;
+	}
+
+	HRESULT hr = Flush();
+	if (FAILED(hr)) {
+		return hr;
+	}
+
+	ULARGE_INTEGER pos = {};
+	hr = m_pStream->Seek(dlibMove, dwOrigin, &pos);
+	if (SUCCEEDED(hr)) {
+		m_pos = pos.QuadPart;
+	}
+
+	if (plibNewPosition) {
+		plibNewPosition->QuadPart = m_pos;
+	}
+
+	return hr;
+}
+
+STDMETHODIMP CWriteBehindStream::SetSize(ULARGE_INTEGER libNewSize)
+{
+	HRESULT hr = Flush();
+	if (FAILED(hr)) {
+		return hr;
+	}
+
+	return m_pStream->SetSize(libNewSize);
+}
+
+STDMETHODIMP CWriteBehindStream::Commit(DWORD grfCommitFlags)
+{
+	HRESULT hr = Flush();
+	if (FAILED(hr)) {
+		return hr;
+	}
+
+	// the output pins of the file writers don't have to implement it
+	hr = m_pStream->Commit(grfCommitFlags);
+	return hr == E_NOTIMPL ? S_OK : hr;
+}
+
+STDMETHODIMP CWriteBehindStream::Stat(STATSTG* pstatstg, DWORD grfStatFlag)
+{
+	HRESULT hr = Flush();
+	if (FAILED(hr)) {
+		return hr;
+	}
+
+	return m_pStream->Stat(pstatstg, grfStatFlag);
+}
@@ -0,0 +1,98 @@
+/*
+ * (C) 2023 see Authors.txt
+ *
+ * This file is part of MPC-BE.
+ *
+ * MPC-BE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MPC-BE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// Collects the many small writes of the Matroska elements into large buffers and
+// writes them to the output stream on its own thread, so a slow target doesn't hold
+// the muxing thread and the inputs. Only the seeks that change the position wait
+// until everything queued is written.
+
+class CWriteBehindStream : public CUnknown, public IStream
+{
+public:
+	constexpr static ULONG  buffer_size     = 4 * MEGABYTE;
+	constexpr static ULONG  buffer_align    = 4096;
+	constexpr static size_t max_queue_depth = 8;
+
+private:
+	struct buffer_t {
+		ULONGLONG pos = 0;
+		ULONG     size = 0;
+		BYTE*     data = nullptr;
+	};
+
+	CComPtr<IStream> m_pStream;
+
+	std::mutex              m_mutex;
+	std::condition_variable m_cvQueue; // a buffer was queued or the thread has to exit
+	std::condition_variable m_cvDone;  // a buffer was written
+	std::deque<buffer_t>    m_queue;
+	std::vector<BYTE*>      m_free;
+	std::thread             m_thread;
+	bool                    m_bExit = false;
+	bool                    m_bWriting = false;
+	std::atomic<HRESULT>    m_hrWrite = S_OK;
+
+	buffer_t  m_buffer;   // being filled
+	ULONGLONG m_pos = 0;  // where the next write goes
+
+	// statistics
+	ULONGLONG m_nBytes = 0;
+	size_t    m_nMaxQueueDepth = 0;
+	ULONGLONG m_startTime = 0;
+	ULONGLONG m_writeTime = 0;
+
+	void ThreadWrite();
+
+	BYTE* AllocBuffer();
+	void QueueBuffer();
+	HRESULT Flush();
+
+public:
+	CWriteBehindStream(IStream* pStream);
+	virtual ~CWriteBehindStream();
+
+	DECLARE_IUNKNOWN;
+	STDMETHODIMP NonDelegatingQueryInterface(REFIID riid, void** ppv);
+
+	// ISequentialStream
+
+	STDMETHODIMP Read(void* pv, ULONG cb, ULONG* pcbRead);
+	STDMETHODIMP Write(const void* pv, ULONG cb, ULONG* pcbWritten);
+
+	// IStream
+
+	STDMETHODIMP Seek(LARGE_INTEGER dlibMove, DWORD dwOrigin, ULARGE_INTEGER* plibNewPosition);
+	STDMETHODIMP SetSize(ULARGE_INTEGER libNewSize);
+	STDMETHODIMP CopyTo(IStream* pstm, ULARGE_INTEGER cb, ULARGE_INTEGER* pcbRead, ULARGE_INTEGER* pcbWritten) { return E_NOTIMPL; }
+	STDMETHODIMP Commit(DWORD grfCommitFlags);
+	STDMETHODIMP Revert() { return E_NOTIMPL; }
+	STDMETHODIMP LockRegion(ULARGE_INTEGER libOffset, ULARGE_INTEGER cb, DWORD dwLockType) { return E_NOTIMPL; }
+	STDMETHODIMP UnlockRegion(ULARGE_INTEGER libOffset, ULARGE_INTEGER cb, DWORD dwLockType) { return E_NOTIMPL; }
+	STDMETHODIMP Stat(STATSTG* pstatstg, DWORD grfStatFlag);
+	STDMETHODIMP Clone(IStream** ppstm) { return E_NOTIMPL; }
+};
@@ -1,6 +1,6 @@
 /*
  * (C) 2003-2006 Gabest
- * (C) 2006-2022 see Authors.txt
+ * (C) 2006-2023 see Authors.txt
  *
  * This file is part of MPC-BE.
  *
@@ -20,6 +20,7 @@
  */
 
 #include "stdafx.h"
+#include <ppl.h>
 #include "AviFile.h"
 #include "DSUtil/AudioParser.h"
 
@@ -373,6 +374,8 @@ HRESULT CAviFile::BuildIndex()
 {
 	EmptyIndex();
 
+	const ULONGLONG startTime = GetPerfCounter();
+
 	DWORD nSuperIndexes = 0;
 
 	for (DWORD track = 0; track < m_avih.dwStreams; track++) {
@@ -383,72 +386,141 @@ HRESULT CAviFile::BuildIndex()
 	}
 
 	if (nSuperIndexes == m_avih.dwStreams) {
+		const UINT64 length = GetLength();
+
+		struct stdindex_t {
+			UINT64 pos;
+			DWORD size;
+			const AVISTDINDEX* p;
+		};
+		std::vector<std::vector<stdindex_t>> stdindexes(m_avih.dwStreams);
+		std::vector<stdindex_t*> reads;
+
 		for (DWORD track = 0; track < m_avih.dwStreams; track++) {
-			strm_t* s = m_strms[track].get();
+			const AVISUPERINDEX* idx = m_strms[track]->indx.get();
+			const DWORD maxEntries = (idx->cb + 8 > FIELD_OFFSET(AVISUPERINDEX, aIndex))
+									 ? (idx->cb + 8 - FIELD_OFFSET(AVISUPERINDEX, aIndex)) / sizeof(idx->aIndex[0]) : 0;
+
+			auto& entries = stdindexes[track];
+			entries.resize(std::min(idx->nEntriesInUse, maxEntries));
+			for (DWORD j = 0; j < entries.size(); ++j) {
+				entries[j].pos  = idx->aIndex[j].qwOffset;
+				entries[j].size = idx->aIndex[j].dwSize;
+				entries[j].p    = nullptr;
+
+				if (entries[j].size < FIELD_OFFSET(AVISTDINDEX, aIndex) || entries[j].pos + entries[j].size > length) {
+					EmptyIndex();
+					return E_FAIL;
+				}
+
+				reads.emplace_back(&entries[j]);
+			}
+		}
 
-			AVISUPERINDEX* idx = (AVISUPERINDEX*)s->indx.get();
+		// the standard indexes of all tracks are read in the file order,
+		// the neighbouring ones at once instead of a seek for each of them
+		constexpr UINT64 maxGap  = 64 * KILOBYTE;
+		constexpr UINT64 maxRead = 4 * MEGABYTE;
 
-			DWORD nEntriesInUse = 0;
+		std::sort(reads.begin(), reads.end(), [](const stdindex_t* a, const stdindex_t* b) {
+			return a->pos < b->pos;
+		});
 
-			for (DWORD j = 0; j < idx->nEntriesInUse; ++j) {
-				Seek(idx->aIndex[j].qwOffset);
+		std::vector<std::vector<BYTE>> buffers;
 
-				AVISTDINDEX stdidx;
-				if (S_OK != ByteRead((BYTE*)&stdidx, FIELD_OFFSET(AVISTDINDEX, aIndex)) || (WORD)stdidx.fcc != 'xi') { // fcc = 'ix00', 'ix01', 'ix02',...
-					EmptyIndex();
-					return E_FAIL;
+		for (size_t i = 0; i < reads.size();) {
+			const UINT64 start = reads[i]->pos;
+			UINT64 end = start + reads[i]->size;
+
+			size_t last = i + 1;
+			for (; last < reads.size(); last++) {
+				const UINT64 next = std::max(end, reads[last]->pos + reads[last]->size);
+				if (reads[last]->pos > end + maxGap || next - start > maxRead) {
+					break;
 				}
+				end = next;
+			}
+
+			auto& buffer = buffers.emplace_back();
+			buffer.resize((size_t)(end - start));
 
-				nEntriesInUse += stdidx.nEntriesInUse;
+			Seek(start);
+			if (S_OK != ByteRead(buffer.data(), buffer.size())) {
+				EmptyIndex();
+				return E_FAIL;
 			}
 
-			s->cs.resize(nEntriesInUse);
+			for (; i < last; i++) {
+				reads[i]->p = (const AVISTDINDEX*)(buffer.data() + (reads[i]->pos - start));
+			}
+		}
 
-			DWORD frame = 0;
-			UINT64 size = 0;
+		// the tracks don't share anything, so their chunks are expanded in parallel
+		std::vector<HRESULT> results(m_avih.dwStreams, S_OK);
 
-			for (DWORD j = 0; j < idx->nEntriesInUse; ++j) {
-				Seek(idx->aIndex[j].qwOffset);
+		concurrency::parallel_for(0ul, m_avih.dwStreams, [&](DWORD track) {
+			strm_t* s = m_strms[track].get();
+			const auto& entries = stdindexes[track];
 
-				std::unique_ptr<BYTE[]> pBuf(new(std::nothrow) BYTE[idx->aIndex[j].dwSize]);
-				AVISTDINDEX* p = (AVISTDINDEX*)pBuf.get();
+			size_t nChunks = 0;
+			for (const auto& entry : entries) {
+				nChunks += entry.p->nEntriesInUse;
+			}
+			s->cs.reserve(nChunks);
 
-				if (!p || S_OK != ByteRead(pBuf.get(), idx->aIndex[j].dwSize) || p->qwBaseOffset >= (DWORDLONG)GetLength()) {
-					EmptyIndex();
-					return E_FAIL;
+			UINT64 size = 0;
+
+			for (const auto& entry : entries) {
+				const AVISTDINDEX* p = entry.p;
+
+				if ((WORD)p->fcc != 'xi' || p->qwBaseOffset >= length) { // fcc = 'ix00', 'ix01', 'ix02',...
+					results[track] = E_FAIL;
+					return;
 				}
 
+				// Matrox's MPEG-2 stuff generates bIndexSubType=16 and wLongsPerEntry=6
+				const DWORD entrySize = p->wLongsPerEntry == 6 ? 3 * sizeof(p->aIndex[0]) : sizeof(p->aIndex[0]);
+				const DWORD nEntries = std::min<DWORD>(p->nEntriesInUse, (entry.size - FIELD_OFFSET(AVISTDINDEX, aIndex)) / entrySize);
+
+				strm_t::chunk c = {};
+
 				if (p->wLongsPerEntry == 6) {
-					// Matrox's MPEG-2 stuff generates bIndexSubType=16 and wLongsPerEntry=6
-					for (DWORD k = 0; k < p->nEntriesInUse * 3; k += 3) {
-						s->cs[frame].filepos = p->qwBaseOffset + p->aIndex[k].dwOffset;
-						s->cs[frame].fKeyFrame = true;
-						s->cs[frame].fChunkHdr = false;
-						s->cs[frame].size = s->cs[frame].orgsize = p->aIndex[k+1].dwOffset;
-
-						++frame;
+					for (DWORD k = 0; k < nEntries * 3; k += 3) {
+						c.filepos   = p->qwBaseOffset + p->aIndex[k].dwOffset;
+						c.fKeyFrame = true;
+						c.fChunkHdr = false;
+						c.size      = c.orgsize = p->aIndex[k+1].dwOffset;
+
+						s->cs.push_back(c);
 					}
 				} else {
-					for (DWORD k = 0; k < p->nEntriesInUse; ++k) {
-						s->cs[frame].size      = size;
-						s->cs[frame].filepos   = p->qwBaseOffset + p->aIndex[k].dwOffset;
-						s->cs[frame].fKeyFrame = !(p->aIndex[k].dwSize&AVISTDINDEX_DELTAFRAME)
-												 || s->strh.fccType == FCC('auds');
-						s->cs[frame].fChunkHdr = false;
-						s->cs[frame].orgsize   = p->aIndex[k].dwSize&AVISTDINDEX_SIZEMASK;
+					for (DWORD k = 0; k < nEntries; ++k) {
+						c.size      = size;
+						c.filepos   = p->qwBaseOffset + p->aIndex[k].dwOffset;
+						c.fKeyFrame = !(p->aIndex[k].dwSize&AVISTDINDEX_DELTAFRAME)
+									  || s->strh.fccType == FCC('auds');
+						c.fChunkHdr = false;
+						c.orgsize   = p->aIndex[k].dwSize&AVISTDINDEX_SIZEMASK;
 
 						if (m_idx1) {
-							s->cs[frame].filepos  -= 8;
-							s->cs[frame].fChunkHdr = true;
+							c.filepos  -= 8;
+							c.fChunkHdr = true;
 						}
 
-						++frame;
+						s->cs.push_back(c);
 						size += s->GetChunkSize(p->aIndex[k].dwSize&AVISTDINDEX_SIZEMASK);
 					}
 				}
 			}
 
 			s->totalsize = size;
+		});
+
+		for (const auto& hr : results) {
+			if (FAILED(hr)) {
+				EmptyIndex();
+				return hr;
+			}
 		}
 	} else if (AVIOLDINDEX* idx = m_idx1.get()) {
 		size_t len    = idx->cb / sizeof(idx->aIndex[0]);
@@ -476,20 +548,22 @@ HRESULT CAviFile::BuildIndex()
 					nFrames++;
 				}
 			}
-			s->cs.resize(nFrames);
+			s->cs.reserve(nFrames);
 
 			// read index
 			size_t frame = 0;
 			UINT64 size = 0;
 			for (size_t i = 0; i < len; i++) {
 				if (TRACKNUM(idx->aIndex[i].dwChunkId) == track) {
-					s->cs[frame].size      = size;
-					s->cs[frame].filepos   = offset + idx->aIndex[i].dwOffset;
-					s->cs[frame].fKeyFrame = !!(idx->aIndex[i].dwFlags&AVIIF_KEYFRAME)
-											 || s->strh.fccType == FCC('auds') // FIXME: some audio index is without any kf flag
-											 || frame == 0; // grrr
-					s->cs[frame].fChunkHdr = i + 1 == len || idx->aIndex[i].dwOffset != idx->aIndex[i + 1].dwOffset;
-					s->cs[frame].orgsize   = idx->aIndex[i].dwSize;
+					strm_t::chunk c;
+					c.size      = size;
+					c.filepos   = offset + idx->aIndex[i].dwOffset;
+					c.fKeyFrame = !!(idx->aIndex[i].dwFlags&AVIIF_KEYFRAME)
+								  || s->strh.fccType == FCC('auds') // FIXME: some audio index is without any kf flag
+								  || frame == 0; // grrr
+					c.fChunkHdr = i + 1 == len || idx->aIndex[i].dwOffset != idx->aIndex[i + 1].dwOffset;
+					c.orgsize   = idx->aIndex[i].dwSize;
+					s->cs.push_back(c);
 
 					frame++;
 					size += s->GetChunkSize(idx->aIndex[i].dwSize);
@@ -505,6 +579,16 @@ HRESULT CAviFile::BuildIndex()
 		m_strms[track]->indx.reset();
 	}
 
+#ifdef DEBUG_OR_LOG
+	size_t nChunks = 0;
+	size_t memSize = 0;
+	for (const auto& s : m_strms) {
+		nChunks += s->cs.size();
+		memSize += s->cs.GetMemorySize();
+	}
+	DLog(L"CAviFile::BuildIndex() : %Iu chunks, index memory %Iu KB, done in %llu ms", nChunks, memSize / KILOBYTE, (GetPerfCounter() - startTime) / 10000ULL);
+#endif
+
 	return S_OK;
 }
 
@@ -553,7 +637,7 @@ bool CAviFile::IsInterleaved(bool fKeepInfo)
 		DWORD n = (DWORD)-1;
 		for (DWORD i = 0; i < m_avih.dwStreams; ++i) {
 			DWORD curchunk = curchunks[i];
-			std::vector<strm_t::chunk>& cs = m_strms[i]->cs;
+			const strm_t::chunks_t& cs = m_strms[i]->cs;
 			if (curchunk >= cs.size()) {
 				continue;
 			}
@@ -702,3 +786,87 @@ bool CAviFile::strm_t::IsRawSubtitleStream()
 {
 	return (strn.Find("Subtitle") == 0 || (strh.fccType == FCC('txts') && cs.size() == 1));
 }
+
+//
+// CAviFile::strm_t::chunks_t
+//
+
+void CAviFile::strm_t::chunks_t::clear()
+{
+	m_blocks.clear();
+	m_filepos.clear();
+	m_size.clear();
+	m_orgsize.clear();
+	m_flags.clear();
+	m_wide.clear();
+
+	m_blocks.shrink_to_fit();
+	m_filepos.shrink_to_fit();
+	m_size.shrink_to_fit();
+	m_orgsize.shrink_to_fit();
+	m_flags.shrink_to_fit();
+}
+
+void CAviFile::strm_t::chunks_t::reserve(const size_t count)
+{
+	m_blocks.reserve((count + block_size - 1) >> block_bits);
+	m_filepos.reserve(count);
+	m_size.reserve(count);
+	m_orgsize.reserve(count);
+	m_flags.reserve(count);
+}
+
+void CAviFile::strm_t::chunks_t::push_back(const chunk& c)
+{
+	const size_t i = m_orgsize.size();
+	if ((i & (block_size - 1)) == 0) {
+		m_blocks.push_back({ c.filepos, c.size });
+	}
+
+	const block_t& block = m_blocks.back();
+	const INT64 filepos = (INT64)(c.filepos - block.filepos);
+	const INT64 size    = (INT64)(c.size - block.size);
+
+	if (filepos > wide && filepos <= INT32_MAX && size > wide && size <= INT32_MAX) {
+		m_filepos.push_back((INT32)filepos);
+		m_size.push_back((INT32)size);
+	} else {
+		m_filepos.push_back(wide);
+		m_size.push_back(wide);
+		m_wide[i] = c;
+	}
+
+	m_orgsize.push_back(c.orgsize);
+	m_flags.push_back((BYTE)((c.fKeyFrame ? flag_keyframe : 0) | (c.fChunkHdr ? flag_chunkhdr : 0)));
+}
+
+CAviFile::strm_t::chunk CAviFile::strm_t::chunks_t::operator[](const size_t i) const
+{
+	if (m_filepos[i] == wide) {
+		const auto it = m_wide.find(i);
+		if (it != m_wide.end()) {
+			return it->second;
+		}
+	}
+
+	const block_t& block = m_blocks[i >> block_bits];
+
+	chunk c;
+	c.filepos   = block.filepos + m_filepos[i];
+	c.size      = block.size + m_size[i];
+	c.orgsize   = m_orgsize[i];
+	c.fKeyFrame = !!(m_flags[i] & flag_keyframe);
+	c.fChunkHdr = !!(m_flags[i] & flag_chunkhdr);
+
+	return c;
+}
+
+size_t CAviFile::strm_t::chunks_t::GetMemorySize() const
+{
+	return m_blocks.capacity() * sizeof(block_t)
+		+ m_filepos.capacity() * sizeof(INT32)
+		+ m_size.capacity() * sizeof(INT32)
+		+ m_orgsize.capacity() * sizeof(DWORD)
+		+ m_flags.capacity() * sizeof(BYTE)
+		+ m_wide.size() * (sizeof(chunk) + 4 * sizeof(void*));
+}
@@ -1,6 +1,6 @@
 /*
  * (C) 2003-2006 Gabest
- * (C) 2006-2022 see Authors.txt
+ * (C) 2006-2023 see Authors.txt
  *
  * This file is part of MPC-BE.
  *
@@ -67,7 +67,44 @@ public:
 			UINT64 filepos;
 			DWORD orgsize;
 		};
-		std::vector<chunk> cs;
+
+		// The index of a long OpenDML file can have millions of chunks, so it is stored packed:
+		// the file positions and the sizes are kept as 32-bit offsets from the first chunk
+		// of their block, the chunks that don't fit are kept whole aside.
+		class chunks_t {
+			static constexpr size_t block_bits = 5;
+			static constexpr size_t block_size = 1 << block_bits;
+			static constexpr INT32  wide       = INT32_MIN;
+
+			enum : BYTE {
+				flag_keyframe = 1,
+				flag_chunkhdr = 2,
+			};
+
+			struct block_t {
+				UINT64 filepos;
+				UINT64 size;
+			};
+
+			std::vector<block_t> m_blocks;
+			std::vector<INT32>   m_filepos;
+			std::vector<INT32>   m_size;
+			std::vector<DWORD>   m_orgsize;
+			std::vector<BYTE>    m_flags;
+			std::map<size_t, chunk> m_wide;
+
+		public:
+			size_t size() const { return m_orgsize.size(); }
+			bool empty() const { return m_orgsize.empty(); }
+
+			void clear();
+			void reserve(const size_t count);
+			void push_back(const chunk& c);
+			chunk operator[](const size_t i) const;
+
+			size_t GetMemorySize() const;
+		};
+		chunks_t cs;
 		UINT64 totalsize;
 		REFERENCE_TIME GetRefTime(DWORD frame, UINT64 size);
 		int GetTime(DWORD frame, UINT64 size);
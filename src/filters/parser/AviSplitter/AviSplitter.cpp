@@ -838,8 +838,7 @@ STDMETHODIMP CAviSplitterFilter::GetKeyFrameCount(UINT& nKFs)
 		}
 
 		for (size_t j = 0; j < s->cs.size(); j++) {
-			CAviFile::strm_t::chunk& c = s->cs[j];
-			if (c.fKeyFrame) {
+			if (s->cs[j].fKeyFrame) {
 				++nKFs;
 			}
 		}
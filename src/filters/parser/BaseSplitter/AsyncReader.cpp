@@ -71,6 +71,12 @@ BOOL CAsyncFileReader::Open(LPCWSTR lpszFileName)
 			m_url = lpszFileName;
 			m_sourcetype = SourceType::HTTP;
 
+			if (m_HTTPAsync.IsSupportsRanges() && !m_HTTPAsync.IsCompressed() && !m_HTTPAsync.IsGoogleMedia()
+					&& ContentLength >= CHTTPSegmentedReader::chunk_size * 4) {
+				m_pSegmentedReader = std::make_unique<CHTTPSegmentedReader>(lpszFileName, ContentLength, m_HTTPAsync.GetValidator(), m_HTTPAsync.GetCustomHeader());
+				m_bSegmentedRead = true;
+			}
+
 			return TRUE;
 		}
 
@@ -94,6 +100,16 @@ STDMETHODIMP CAsyncFileReader::SyncRead(LONGLONG llPosition, LONG lLength, BYTE*
 	}
 
 	if (m_url.GetLength()) {
+		if (m_bSegmentedRead) {
+			if (S_OK == m_pSegmentedReader->Read(llPosition, pBuffer, lLength)) {
+				return S_OK;
+			}
+
+			// the reader is kept for the statistics
+			DLog(L"CAsyncFileReader::SyncRead() : range requests failed, continue with a single connection");
+			m_bSegmentedRead = false;
+		}
+
 		auto RetryOnError = [&] {
 			const DWORD dwError = GetLastError();
 			if (dwError == ERROR_INTERNET_CONNECTION_RESET
@@ -168,6 +184,16 @@ STDMETHODIMP CAsyncFileReader::SyncRead(LONGLONG llPosition, LONG lLength, BYTE*
 	}
 }
 
+STDMETHODIMP CAsyncFileReader::GetCacheStatus(UINT64& hits, UINT64& misses, UINT64& bytes)
+{
+	if (!m_pSegmentedReader) {
+		return S_FALSE;
+	}
+
+	m_pSegmentedReader->GetCacheStatus(hits, misses, bytes);
+	return S_OK;
+}
+
 STDMETHODIMP CAsyncFileReader::Length(LONGLONG* pTotal, LONGLONG* pAvailable)
 {
 	const LONGLONG len = GetLength();
@@ -23,6 +23,7 @@
 
 #include "MultiFiles.h"
 #include "DSUtil/HTTPAsync.h"
+#include "DSUtil/HTTPSegmentedReader.h"
 
 interface __declspec(uuid("6DDB4EE7-45A0-4459-A508-BD77B32C91B2"))
 ISyncReader :
@@ -33,6 +34,7 @@ public IUnknown {
 	STDMETHOD_(void, SetPTSOffset)(REFERENCE_TIME* rtPTSOffset) PURE;
 	STDMETHOD_(int, GetSourceType)() PURE;
 	STDMETHOD (ReOpen)(CHdmvClipInfo::CPlaylist& Items) PURE;
+	STDMETHOD (GetCacheStatus)(UINT64& hits, UINT64& misses, UINT64& bytes) PURE;
 };
 
 interface __declspec(uuid("7D55F67A-826E-40B9-8A7D-3DF0CBBD272D"))
@@ -59,6 +61,8 @@ protected:
 
 	BOOL m_bSupportURL = FALSE;
 	CHTTPAsync m_HTTPAsync;
+	std::unique_ptr<CHTTPSegmentedReader> m_pSegmentedReader;
+	bool m_bSegmentedRead = false;
 	ULONGLONG m_total = 0;
 	LONGLONG m_pos = 0;
 	CString m_url;
@@ -91,6 +95,7 @@ public:
 	STDMETHODIMP_(void) SetPTSOffset(REFERENCE_TIME* rtPTSOffset) { m_pCurrentPTSOffset = rtPTSOffset; };
 	STDMETHODIMP_(int) GetSourceType() { return (int)m_sourcetype; }
 	STDMETHODIMP ReOpen(CHdmvClipInfo::CPlaylist& Items) { return OpenFiles(Items) ? S_OK : E_FAIL; }
+	STDMETHODIMP GetCacheStatus(UINT64& hits, UINT64& misses, UINT64& bytes);
 
 	// IFileHandle
 	STDMETHODIMP_(HANDLE) GetFileHandle() { return m_hFile; }
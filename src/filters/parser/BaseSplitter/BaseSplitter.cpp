@@ -86,6 +86,7 @@ STDMETHODIMP CBaseSplitterFilter::NonDelegatingQueryInterface(REFIID riid, void*
 		QI2(IAMExtendedSeeking)
 		QI(IKeyFrameInfo)
 		QI(IBufferInfo)
+		QI(IBufferInfo2)
 		QI(IExFilterConfig)
 		QI(IPropertyBag)
 		QI(IPropertyBag2)
@@ -875,6 +876,19 @@ STDMETHODIMP_(DWORD) CBaseSplitterFilter::GetPriority()
 	return m_priority;
 }
 
+// IBufferInfo2
+
+STDMETHODIMP CBaseSplitterFilter::GetCacheStatus(UINT64& hits, UINT64& misses, UINT64& bytes)
+{
+	CAutoLock cAutoLock(m_pLock);
+
+	if (m_pSyncReader) {
+		return m_pSyncReader->GetCacheStatus(hits, misses, bytes);
+	}
+
+	return S_FALSE;
+}
+
 // CExFilterConfig
 
 STDMETHODIMP CBaseSplitterFilter::GetInt(LPCSTR field, int *value)
@@ -52,7 +52,7 @@ class CBaseSplitterFilter
 	, public IAMMediaContent
 	, public IAMExtendedSeeking
 	, public IKeyFrameInfo
-	, public IBufferInfo
+	, public IBufferInfo2
 	, public CExFilterConfigImpl
 {
 	CCritSec m_csPinMap;
@@ -219,6 +219,10 @@ public:
 	STDMETHODIMP GetStatus(int i, int& samples, int& size);
 	STDMETHODIMP_(DWORD) GetPriority();
 
+	// IBufferInfo2
+
+	STDMETHODIMP GetCacheStatus(UINT64& hits, UINT64& misses, UINT64& bytes);
+
 	// IExFilterConfig
 
 	STDMETHODIMP GetInt(LPCSTR field, int *value) override;
@@ -238,6 +238,7 @@ bool CDSMSplitterFilter::DemuxLoop()
 STDMETHODIMP CDSMSplitterFilter::GetKeyFrameCount(UINT& nKFs)
 {
 	CheckPointer(m_pFile, E_UNEXPECTED);
+	CAutoLock cAutoLock(&m_pFile->m_csSyncPoints);
 	nKFs = m_pFile->m_sps.size();
 	return S_OK;
 }
@@ -252,8 +253,12 @@ STDMETHODIMP CDSMSplitterFilter::GetKeyFrames(const GUID* pFormat, REFERENCE_TIM
 		return E_INVALIDARG;
 	}
 
+	CAutoLock cAutoLock(&m_pFile->m_csSyncPoints);
+
 	// these aren't really the keyframes, but quicky accessable points in the stream
-	for (nKFs = 0; nKFs < m_pFile->m_sps.size(); nKFs++) {
+	// the index of a growing file can get new points after GetKeyFrameCount()
+	const UINT count = std::min(nKFs, (UINT)m_pFile->m_sps.size());
+	for (nKFs = 0; nKFs < count; nKFs++) {
 		pKFs[nKFs] = m_pFile->m_sps[nKFs].rt;
 	}
 
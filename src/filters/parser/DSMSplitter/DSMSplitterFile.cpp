@@ -1,6 +1,6 @@
 /*
  * (C) 2003-2006 Gabest
- * (C) 2006-2021 see Authors.txt
+ * (C) 2006-2023 see Authors.txt
  *
  * This file is part of MPC-BE.
  *
@@ -24,8 +24,10 @@
 #include "DSUtil/DSUtil.h"
 #include <moreuuids.h>
 
+#define MAX_PART_DISTANCE (16 * MEGABYTE) // of the last partial index from the end, the muxer writes them every 4 MB
+
 CDSMSplitterFile::CDSMSplitterFile(IAsyncReader* pReader, HRESULT& hr, IDSMResourceBagImpl& res, IDSMChapterBagImpl& chap)
-	: CBaseSplitterFile(pReader, hr, FM_FILE | FM_FILE_DL)
+	: CBaseSplitterFile(pReader, hr, FM_FILE | FM_FILE_DL | FM_FILE_VAR)
 	, m_rtFirst(0)
 	, m_rtDuration(0)
 {
@@ -82,7 +84,7 @@ HRESULT CDSMSplitterFile::Init(IDSMResourceBagImpl& res, IDSMChapterBagImpl& cha
 		} else if (type == DSMP_STREAMINFO) {
 			Read(len-1, m_sim[(BYTE)BitRead(8)]);
 		} else if (type == DSMP_SYNCPOINTS) {
-			Read(len, m_sps);
+			m_bFullIndex = Read(len, m_sps);
 		} else if (type == DSMP_RESOURCE) {
 			Read(len, res);
 		} else if (type == DSMP_CHAPTERS) {
@@ -113,7 +115,7 @@ HRESULT CDSMSplitterFile::Init(IDSMResourceBagImpl& res, IDSMChapterBagImpl& cha
 						i = j;
 					}
 				} else if (type == DSMP_SYNCPOINTS) {
-					Read(len, m_sps);
+					m_bFullIndex = Read(len, m_sps);
 				} else if (type == DSMP_RESOURCE) {
 					Read(len, res);
 				} else if (type == DSMP_CHAPTERS) {
@@ -124,6 +126,10 @@ HRESULT CDSMSplitterFile::Init(IDSMResourceBagImpl& res, IDSMChapterBagImpl& cha
 			}
 		}
 
+	if (!m_bFullIndex && IsRandomAccess()) {
+		ReadSyncPointsParts();
+	}
+
 	if (m_rtFirst < 0) {
 		m_rtDuration += m_rtFirst;
 		m_rtFirst = 0;
@@ -234,6 +240,28 @@ bool CDSMSplitterFile::Read(__int64 len, std::vector<SyncPoint>& sps)
 	return true;
 }
 
+bool CDSMSplitterFile::Read(__int64 len, std::vector<SyncPoint>& sps, UINT64& back)
+{
+	sps.clear();
+
+	if (len < 1) {
+		return false;
+	}
+
+	int iBack = (int)BitRead(3) + 1;
+	BitRead(5); // reserved
+	len--;
+
+	if (len < iBack) {
+		return false;
+	}
+
+	back = BitRead(iBack<<3);
+	len -= iBack;
+
+	return Read(len, sps);
+}
+
 bool CDSMSplitterFile::Read(__int64 len, CStreamInfoMap& im)
 {
 	while (len >= 5) {
@@ -304,8 +332,96 @@ __int64 CDSMSplitterFile::Read(__int64 len, CStringW& str)
 	return i;
 }
 
+void CDSMSplitterFile::ReadSyncPointsParts()
+{
+	const __int64 length = GetLength();
+	const __int64 limit = 65536;
+
+	dsmp_t type;
+	UINT64 syncpos, len;
+
+	// the last complete partial index, the ones up to m_posPart are merged already
+	__int64 posLast = 0;
+
+	for (__int64 seekpos = length; !posLast && seekpos > m_posPart && length - seekpos < MAX_PART_DISTANCE; ) {
+		seekpos = std::max(m_posPart, seekpos - limit);
+		Seek(seekpos);
+
+		while (Sync(syncpos, type, len, limit) && (__int64)syncpos < seekpos + limit) {
+			__int64 pos = GetPos();
+
+			if (type == DSMP_SYNCPOINTS_PART && (__int64)syncpos > m_posPart && pos + (__int64)len <= length) {
+				posLast = std::max(posLast, (__int64)syncpos);
+			}
+
+			Seek(pos + len);
+		}
+	}
+
+	if (!posLast) {
+		m_lenPart = length;
+		return;
+	}
+
+	// each partial index points to the previous one
+	std::list<std::vector<SyncPoint>> parts;
+
+	for (__int64 pos = posLast; pos > m_posPart; ) {
+		Seek(pos);
+
+		std::vector<SyncPoint> sps;
+		UINT64 back = 0;
+		if (!Sync(syncpos, type, len, 0) || (__int64)syncpos != pos || type != DSMP_SYNCPOINTS_PART || !Read(len, sps, back)) {
+			DLog(L"CDSMSplitterFile::ReadSyncPointsParts() : broken partial index at %I64d", pos);
+			break;
+		}
+
+		parts.emplace_front(std::move(sps));
+
+		if (back == 0 || back > (UINT64)pos) {
+			break;
+		}
+		pos -= back;
+	}
+
+	for (const auto& sps : parts) {
+		MergeSyncPoints(sps);
+	}
+
+	DLog(L"CDSMSplitterFile::ReadSyncPointsParts() : %Iu partial indexes read, %Iu syncpoints", parts.size(), m_sps.size());
+
+	m_posPart = posLast;
+	m_lenPart = length;
+}
+
+void CDSMSplitterFile::MergeSyncPoints(const std::vector<SyncPoint>& sps)
+{
+	if (sps.empty()) {
+		return;
+	}
+
+	CAutoLock cAutoLock(&m_csSyncPoints);
+
+	const bool bSorted = m_sps.empty() || m_sps.back().rt <= sps.front().rt;
+	m_sps.insert(m_sps.end(), sps.cbegin(), sps.cend());
+
+	if (!bSorted) {
+		std::stable_sort(m_sps.begin(), m_sps.end(), [](const SyncPoint& a, const SyncPoint& b) {
+			return a.rt < b.rt;
+		});
+		m_sps.erase(std::unique(m_sps.begin(), m_sps.end(), [](const SyncPoint& a, const SyncPoint& b) {
+			return a.rt == b.rt && a.fp == b.fp;
+		}), m_sps.end());
+	}
+}
+
 __int64 CDSMSplitterFile::FindSyncPoint(REFERENCE_TIME rt)
 {
+	if (!m_bFullIndex && IsVariableSize() && GetLength() > m_lenPart) {
+		// the file is still being written, take the new partial indexes
+		ReadSyncPointsParts();
+	}
+
 	if (/*!m_sps.IsEmpty()*/ m_sps.size() > 1) {
 		int i = range_bsearch(m_sps, m_rtFirst + rt);
 		return i >= 0 ? m_sps[i].fp : 0;
@@ -1,6 +1,6 @@
 /*
  * (C) 2003-2006 Gabest
- * (C) 2006-2021 see Authors.txt
+ * (C) 2006-2023 see Authors.txt
  *
  * This file is part of MPC-BE.
  *
@@ -29,6 +29,15 @@ class CDSMSplitterFile : public CBaseSplitterFile
 {
 	HRESULT Init(IDSMResourceBagImpl& res, IDSMChapterBagImpl& chap);
 
+	// the file has no final index while it is being written or after the writing was interrupted,
+	// then the syncpoints are taken from the partial indexes
+	bool    m_bFullIndex = false;
+	__int64 m_posPart    = 0; // the last merged partial index
+	__int64 m_lenPart    = 0; // the file length when the partial indexes were read
+
+	void ReadSyncPointsParts();
+	void MergeSyncPoints(const std::vector<SyncPoint>& sps);
+
 public:
 	CDSMSplitterFile(IAsyncReader* pReader, HRESULT& hr, IDSMResourceBagImpl& res, IDSMChapterBagImpl& chap);
 
@@ -36,6 +45,7 @@ public:
 	REFERENCE_TIME m_rtFirst, m_rtDuration;
 
 	std::vector<SyncPoint> m_sps;
+	CCritSec m_csSyncPoints;
 
 	typedef std::map<CStringA, CStringW> CStreamInfoMap;
 	CStreamInfoMap m_fim;
@@ -46,6 +56,7 @@ public:
 	bool Read(__int64 len, BYTE& id, CMediaType& mt);
 	bool Read(__int64 len, CPacket* p, bool fData = true);
 	bool Read(__int64 len, std::vector<SyncPoint>& sps);
+	bool Read(__int64 len, std::vector<SyncPoint>& sps, UINT64& back);
 	bool Read(__int64 len, CStreamInfoMap& im);
 	bool Read(__int64 len, IDSMResourceBagImpl& res);
 	bool Read(__int64 len, IDSMChapterBagImpl& chap);
@@ -137,6 +137,11 @@ CFLVSplitterFilter::CFLVSplitterFilter(LPUNKNOWN pUnk, HRESULT* phr)
 	//memset(&meta, 0, sizeof(meta));
 }
 
+CFLVSplitterFilter::~CFLVSplitterFilter()
+{
+	StopThreadIndex();
+}
+
 STDMETHODIMP CFLVSplitterFilter::QueryFilterInfo(FILTER_INFO* pInfo)
 {
 	CheckPointer(pInfo, E_POINTER);
@@ -468,10 +473,326 @@ bool CFLVSplitterFilter::Sync(__int64& pos)
 	return false;
 }
 
+#define INDEX_PUBLISH_COUNT 1024
+#define INDEX_CACHE_SIZE    (64 * MEGABYTE)
+
+static const char   idx_signature[8] = { 'F', 'L', 'V', 'I', 'N', 'D', 'E', 'X' };
+static const UINT16 idx_version = 1;
+static const size_t idx_header_size = sizeof(idx_signature) + sizeof(UINT16) + sizeof(UINT32) + sizeof(UINT32);
+
+CStringW CFLVSplitterFilter::GetIndexFileName(LPCWSTR path)
+{
+	WIN32_FILE_ATTRIBUTE_DATA fad;
+	if (!path || !path[0] || !GetFileAttributesExW(path, GetFileExInfoStandard, &fad) || (fad.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+		return L"";
+	}
+
+	WCHAR lpszTempPath[MAX_PATH] = {};
+	if (!GetTempPathW(MAX_PATH, lpszTempPath)) {
+		return L"";
+	}
+
+	CStringW folder(lpszTempPath);
+	folder.Append(L"mpc-be_index\\");
+	if (!CreateDirectoryW(folder, nullptr) && GetLastError() != ERROR_ALREADY_EXISTS) {
+		return L"";
+	}
+
+	// FNV-1a of the path, size and modification time, a recording that is still growing gets a new name
+	UINT64 hash = 0xcbf29ce484222325ull;
+	auto Hash = [&hash](const void* data, const size_t size) {
+		for (size_t i = 0; i < size; i++) {
+			hash = (hash ^ ((const BYTE*)data)[i]) * 0x100000001b3ull;
+		}
+	};
+
+	CStringW key(path);
+	key.MakeLower();
+	Hash(key.GetString(), key.GetLength() * sizeof(WCHAR));
+	Hash(&fad.nFileSizeHigh, sizeof(fad.nFileSizeHigh));
+	Hash(&fad.nFileSizeLow, sizeof(fad.nFileSizeLow));
+	Hash(&fad.ftLastWriteTime, sizeof(fad.ftLastWriteTime));
+
+	CStringW filename;
+	filename.Format(L"%s%016I64x.flvidx", folder.GetString(), hash);
+	return filename;
+}
+
+bool CFLVSplitterFilter::LoadIndex(const CStringW& filename)
+{
+	HANDLE hFile = CreateFileW(filename, GENERIC_READ | FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	std::vector<BYTE> data;
+	LARGE_INTEGER filesize = {};
+	if (GetFileSizeEx(hFile, &filesize) && filesize.QuadPart >= (LONGLONG)idx_header_size && filesize.QuadPart <= (LONGLONG)INDEX_CACHE_SIZE) {
+		data.resize((size_t)filesize.QuadPart);
+		DWORD dwSizeRead = 0;
+		if (!ReadFile(hFile, data.data(), (DWORD)data.size(), &dwSizeRead, nullptr) || dwSizeRead != data.size()) {
+			data.clear();
+		}
+	}
+
+	if (data.size()) {
+		// the write time keeps the LRU order of the cache files
+		FILETIME ft;
+		GetSystemTimeAsFileTime(&ft);
+		SetFileTime(hFile, nullptr, nullptr, &ft);
+	}
+	CloseHandle(hFile);
+
+	const BYTE* p = data.data();
+	auto Read = [&](void* dst, const size_t size) {
+		memcpy(dst, p, size);
+		p += size;
+	};
+
+	char signature[sizeof(idx_signature)] = {};
+	UINT16 version = 0;
+	UINT32 dataOffset = 0;
+	UINT32 count = 0;
+	if (data.size()) {
+		Read(signature, sizeof(signature));
+		Read(&version, sizeof(version));
+		Read(&dataOffset, sizeof(dataOffset));
+		Read(&count, sizeof(count));
+	}
+
+	std::vector<SyncPoint> sps;
+	if (!memcmp(signature, idx_signature, sizeof(signature)) && version == idx_version && dataOffset == m_DataOffset
+			&& count > 1 && data.size() == idx_header_size + count * sizeof(SyncPoint)) {
+		sps.resize(count);
+		Read(sps.data(), count * sizeof(SyncPoint));
+
+		const __int64 length = m_pFile->GetLength();
+		for (size_t i = 0; i < sps.size(); i++) {
+			if (sps[i].fp < (__int64)m_DataOffset + 4 || sps[i].fp >= length || (i && sps[i].rt < sps[i - 1].rt)) {
+				sps.clear();
+				break;
+			}
+		}
+	}
+
+	if (sps.empty()) {
+		DLog(L"CFLVSplitterFilter::LoadIndex() : '%s' is invalid", filename.GetString());
+		DeleteFileW(filename);
+		return false;
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutexSyncPoints);
+	m_sps.swap(sps);
+	m_bSyncPointsComplete = true;
+
+	DLog(L"CFLVSplitterFilter::LoadIndex() : %zu sync points loaded from '%s'", m_sps.size(), filename.GetString());
+
+	return true;
+}
+
+void CFLVSplitterFilter::SaveIndex(const CStringW& filename, const std::vector<SyncPoint>& sps)
+{
+	const UINT32 count = (UINT32)sps.size();
+	const UINT32 dataOffset = m_DataOffset;
+
+	std::vector<BYTE> data(idx_header_size + count * sizeof(SyncPoint));
+	if (data.size() > INDEX_CACHE_SIZE) {
+		return;
+	}
+
+	BYTE* p = data.data();
+	auto Write = [&](const void* src, const size_t size) {
+		memcpy(p, src, size);
+		p += size;
+	};
+
+	Write(idx_signature, sizeof(idx_signature));
+	Write(&idx_version, sizeof(idx_version));
+	Write(&dataOffset, sizeof(dataOffset));
+	Write(&count, sizeof(count));
+	Write(sps.data(), count * sizeof(SyncPoint));
+
+	// write to a temporary name first, so an interrupted save never leaves a truncated file
+	const CStringW tmpname = filename + L".tmp";
+	HANDLE hFile = CreateFileW(tmpname, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		return;
+	}
+
+	DWORD dwSizeWritten = 0;
+	const BOOL bWritten = WriteFile(hFile, data.data(), (DWORD)data.size(), &dwSizeWritten, nullptr) && dwSizeWritten == data.size();
+	CloseHandle(hFile);
+
+	if (!bWritten || !MoveFileExW(tmpname, filename, MOVEFILE_REPLACE_EXISTING)) {
+		DLog(L"CFLVSplitterFilter::SaveIndex() : failed to write '%s'", filename.GetString());
+		DeleteFileW(tmpname);
+		return;
+	}
+
+	// drop the least recently used indexes above the cache size
+	const CStringW folder = filename.Left(filename.ReverseFind(L'\\') + 1);
+
+	struct file_t {
+		CStringW name;
+		UINT64 size;
+		UINT64 lastuse;
+	};
+	std::vector<file_t> files;
+	UINT64 size = 0;
+
+	WIN32_FIND_DATAW fd;
+	HANDLE hFind = FindFirstFileW(folder + L"*.flvidx", &fd);
+	if (hFind != INVALID_HANDLE_VALUE) {
+		do {
+			if (!(fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+				const UINT64 filesize = ((UINT64)fd.nFileSizeHigh << 32) | fd.nFileSizeLow;
+				const UINT64 lastuse = ((UINT64)fd.ftLastWriteTime.dwHighDateTime << 32) | fd.ftLastWriteTime.dwLowDateTime;
+				files.emplace_back(file_t{ fd.cFileName, filesize, lastuse });
+				size += filesize;
+			}
+		} while (FindNextFileW(hFind, &fd));
+		FindClose(hFind);
+	}
+
+	std::sort(files.begin(), files.end(), [](const file_t& a, const file_t& b) {
+		return a.lastuse < b.lastuse;
+	});
+
+	for (const auto& file : files) {
+		if (size <= INDEX_CACHE_SIZE) {
+			break;
+		}
+		DeleteFileW(folder + file.name);
+		size -= file.size;
+	}
+}
+
+void CFLVSplitterFilter::ThreadBuildIndex(const CStringW path, const CStringW filename)
+{
+	// CAsyncFileReader::SyncRead() seeks and reads the shared handle without a lock,
+	// so the scan must not use the reader of the demuxer
+	HRESULT hr = S_OK;
+	CComPtr<IAsyncReader> pAsyncReader = (IAsyncReader*)DNew CAsyncFileReader(path, hr, FALSE);
+	if (FAILED(hr)) {
+		return;
+	}
+
+	CBaseSplitterFileEx file(pAsyncReader, hr, FM_FILE);
+	if (FAILED(hr) || file.GetLength() != m_pFile->GetLength()) {
+		return;
+	}
+
+	const LONGLONG llStart = GetPerfCounter();
+
+	// without video a sync point per second is enough, every audio tag can start the playback
+	const BYTE masterTagType = GetOutputPin(FLV_VIDEODATA) ? FLV_VIDEODATA : FLV_AUDIODATA;
+	const UINT32 timeStampOffset = m_TimeStampOffset;
+	const __int64 end = file.GetLength();
+
+	std::vector<SyncPoint> sps;
+	size_t published = 0;
+	auto Publish = [&] {
+		std::unique_lock<std::mutex> lock(m_mutexSyncPoints);
+		m_sps.insert(m_sps.end(), sps.cbegin() + published, sps.cend());
+		published = sps.size();
+	};
+
+	UINT32 prevDataSize  = 0;
+	UINT32 prevTimeStamp = 0;
+	bool bComplete = false;
+	unsigned count = 0;
+
+	// only the tag headers are read, the payloads are skipped
+	file.Seek(m_DataOffset);
+	for (;;) {
+		if ((++count & 0xff) == 0 && m_evStopThreadIndex.Check()) {
+			return;
+		}
+
+		const __int64 pos = file.GetPos();
+		if (end - pos < 15) {
+			bComplete = true;
+			break;
+		}
+
+		BYTE buf[15 + 2];
+		if (file.ByteRead(buf, 15) != S_OK) {
+			break;
+		}
+
+		const UINT32 PreviousTagSize = AV_RB32(buf);
+		const BYTE   TagType         = buf[4];
+		const UINT32 DataSize        = AV_RB24(buf + 5);
+		const UINT32 TimeStamp       = AV_RB24(buf + 8) | ((UINT32)buf[11] << 24);
+		const __int64 next           = pos + 15 + DataSize;
+
+		// the same acceptance as in Sync()
+		if (!IsValidTag(TagType) || (count > 1 && PreviousTagSize != prevDataSize + 11 && TimeStamp < prevTimeStamp)) {
+			DLog(L"CFLVSplitterFilter::ThreadBuildIndex() : invalid tag at %I64d, the index is incomplete", pos);
+			break;
+		}
+		if (next > end) {
+			// the recording was cut in the middle of the last tag
+			bComplete = true;
+			break;
+		}
+
+		const REFERENCE_TIME rt = 10000i64 * (UINT32)(TimeStamp - timeStampOffset);
+		if (TagType == masterTagType && DataSize && (sps.empty() || rt > sps.back().rt)) {
+			bool bSyncPoint = false;
+			if (TagType == FLV_VIDEODATA) {
+				if (file.ByteRead(buf + 15, std::min(DataSize, 2u)) == S_OK) {
+					const BYTE frameType = buf[15] >> 4;
+					const BYTE codecID   = buf[15] & 0x0f;
+					// the AVC/HEVC sequence headers are not frames
+					bSyncPoint = frameType == 1 && (!IsAVCCodec(codecID) || (DataSize >= 2 && buf[16] == 1));
+				}
+			} else {
+				bSyncPoint = sps.empty() || rt >= sps.back().rt + UNITS;
+			}
+
+			if (bSyncPoint) {
+				sps.push_back({ rt, pos + 4 });
+				if (sps.size() - published >= INDEX_PUBLISH_COUNT) {
+					Publish();
+				}
+			}
+		}
+
+		prevDataSize  = DataSize;
+		prevTimeStamp = TimeStamp;
+		file.Seek(next);
+	}
+
+	Publish();
+
+	if (bComplete) {
+		{
+			std::unique_lock<std::mutex> lock(m_mutexSyncPoints);
+			m_bSyncPointsComplete = true;
+		}
+		if (filename.GetLength() && sps.size() > 1) {
+			SaveIndex(filename, sps);
+		}
+	}
+
+	DLog(L"CFLVSplitterFilter::ThreadBuildIndex() : %zu sync points%s in %I64d ms", sps.size(), bComplete ? L"" : L" (incomplete)", (GetPerfCounter() - llStart) / 10000);
+}
+
+void CFLVSplitterFilter::StopThreadIndex()
+{
+	if (m_ThreadIndex.joinable()) {
+		m_evStopThreadIndex.Set();
+		m_ThreadIndex.join();
+	}
+}
+
 HRESULT CFLVSplitterFilter::CreateOutputs(IAsyncReader* pAsyncReader)
 {
 	CheckPointer(pAsyncReader, E_POINTER);
 
+	StopThreadIndex();
+
 	HRESULT hr = E_FAIL;
 
 	m_pFile.reset(DNew CBaseSplitterFileEx(pAsyncReader, hr, FM_FILE | FM_FILE_DL | FM_STREAM));
@@ -536,6 +857,7 @@ HRESULT CFLVSplitterFilter::CreateOutputs(IAsyncReader* pAsyncReader)
 	BYTE vCodecId = 0;
 
 	m_sps.clear();
+	m_bSyncPointsComplete = false;
 
 	BOOL bVideoMetadataExists = FALSE;
 	BOOL bAudioMetadataExists = FALSE;
@@ -1263,6 +1585,16 @@ HRESULT CFLVSplitterFilter::CreateOutputs(IAsyncReader* pAsyncReader)
 		m_pFile->Seek(m_DataOffset);
 	}
 
+	if (m_sps.empty() && m_pOutputs.size() && m_pFile->IsRandomAccess() && !m_pFile->IsURL()) {
+		const CStringW path = GetPartFilename(pAsyncReader);
+		const CStringW filename = GetIndexFileName(path);
+		if (path.GetLength() && (filename.IsEmpty() || !LoadIndex(filename))) {
+			m_evStopThreadIndex.Reset();
+			m_ThreadIndex = std::thread([this, path, filename] { ThreadBuildIndex(path, filename); });
+			::SetThreadPriority(m_ThreadIndex.native_handle(), THREAD_PRIORITY_LOWEST);
+		}
+	}
+
 	m_pFile->Seek(m_DataOffset);
 
 	return m_pOutputs.size() > 0 ? S_OK : E_FAIL;
@@ -1294,12 +1626,16 @@ void CFLVSplitterFilter::DemuxSeek(REFERENCE_TIME rt)
 
 	__int64 estimPos = 0;
 
-	if (m_sps.size() > 1 && rt <= m_sps.back().rt) {
-		const int i = range_bsearch(m_sps, rt);
-		if (i >= 0) {
-			estimPos = m_sps[i].fp - 4;
-			m_pFile->Seek(estimPos);
-			return;
+	{
+		// the index built in the background is usable up to its last sync point while it grows
+		std::unique_lock<std::mutex> lock(m_mutexSyncPoints);
+		if (m_sps.size() > 1 && (rt <= m_sps.back().rt || m_bSyncPointsComplete)) {
+			const int i = range_bsearch(m_sps, rt);
+			if (i >= 0) {
+				estimPos = m_sps[i].fp - 4;
+				m_pFile->Seek(estimPos);
+				return;
+			}
 		}
 	}
 
@@ -1444,6 +1780,8 @@ NextTag:
 STDMETHODIMP CFLVSplitterFilter::GetKeyFrameCount(UINT& nKFs)
 {
 	CheckPointer(m_pFile, E_UNEXPECTED);
+
+	std::unique_lock<std::mutex> lock(m_mutexSyncPoints);
 	nKFs = m_sps.size();
 	return S_OK;
 }
@@ -1458,8 +1796,11 @@ STDMETHODIMP CFLVSplitterFilter::GetKeyFrames(const GUID* pFormat, REFERENCE_TIM
 		return E_INVALIDARG;
 	}
 
-	for (nKFs = 0; nKFs < m_sps.size(); nKFs++) {
-		pKFs[nKFs] = m_sps[nKFs].rt;
+	// the index can grow after GetKeyFrameCount()
+	std::unique_lock<std::mutex> lock(m_mutexSyncPoints);
+	nKFs = (UINT)std::min((size_t)nKFs, m_sps.size());
+	for (UINT i = 0; i < nKFs; i++) {
+		pKFs[i] = m_sps[i].rt;
 	}
 
 	return S_OK;
@@ -1,6 +1,6 @@
 /*
  * (C) 2003-2006 Gabest
- * (C) 2006-2021 see Authors.txt
+ * (C) 2006-2023 see Authors.txt
  *
  * This file is part of MPC-BE.
  *
@@ -21,6 +21,8 @@
 
 #pragma once
 
+#include <mutex>
+#include <thread>
 #include "../BaseSplitter/BaseSplitter.h"
 
 #define FlvSplitterName L"MPC FLV Splitter"
@@ -126,6 +128,19 @@ class __declspec(uuid("47E792CF-0BBE-4F7A-859C-194B0768650A"))
 	};
 
 	std::vector<SyncPoint> m_sps;
+	std::mutex             m_mutexSyncPoints;
+	bool                   m_bSyncPointsComplete = false; // m_sps covers the whole file
+
+	// keyframe index of the files without keyframes metadata (stream recordings),
+	// built in the background and kept in the temporary folder for the next opening
+	CAMEvent    m_evStopThreadIndex;
+	std::thread m_ThreadIndex;
+	void ThreadBuildIndex(const CStringW path, const CStringW filename);
+	void StopThreadIndex();
+
+	static CStringW GetIndexFileName(LPCWSTR path);
+	bool LoadIndex(const CStringW& filename);
+	void SaveIndex(const CStringW& filename, const std::vector<SyncPoint>& sps);
 
 	CString AMF0GetString(UINT64 end);
 	bool ParseAMF0(UINT64 end, const CString key, std::vector<AMF0> &AMF0Array);
@@ -140,6 +155,7 @@ protected:
 
 public:
 	CFLVSplitterFilter(LPUNKNOWN pUnk, HRESULT* phr);
+	virtual ~CFLVSplitterFilter();
 
 	// CBaseFilter
 	STDMETHODIMP_(HRESULT) QueryFilterInfo(FILTER_INFO* pInfo);
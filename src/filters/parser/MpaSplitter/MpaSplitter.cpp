@@ -113,7 +113,7 @@ HRESULT CMpaSplitterFilter::CreateOutputs(IAsyncReader* pAsyncReader)
 
 	HRESULT hr = E_FAIL;
 
-	m_pFile.reset(DNew CMpaSplitterFile(pAsyncReader, hr));
+	m_pFile.reset(DNew CMpaSplitterFile(pAsyncReader, hr, GetPartFilename(pAsyncReader)));
 	if (!m_pFile) {
 		return E_OUTOFMEMORY;
 	}
@@ -162,15 +162,11 @@ bool CMpaSplitterFilter::DemuxInit()
 
 void CMpaSplitterFilter::DemuxSeek(REFERENCE_TIME rt)
 {
-	__int64 startpos = m_pFile->GetStartPos();
-	__int64 endpos = m_pFile->GetEndPos();
-
 	if (rt <= 0 || m_pFile->GetDuration() <= 0) {
-		m_pFile->Seek(startpos);
+		m_pFile->Seek(m_pFile->GetStartPos());
 		m_rtime = 0;
 	} else {
-		m_pFile->Seek(startpos + (__int64)((1.0 * rt / m_pFile->GetDuration()) * (endpos - startpos)));
-		m_rtime = rt;
+		m_rtime = m_pFile->SeekToTime(rt);
 	}
 }
 
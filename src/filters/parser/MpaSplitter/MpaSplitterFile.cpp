@@ -26,7 +26,7 @@
 
 #include <moreuuids.h>
 
-CMpaSplitterFile::CMpaSplitterFile(IAsyncReader* pAsyncReader, HRESULT& hr)
+CMpaSplitterFile::CMpaSplitterFile(IAsyncReader* pAsyncReader, HRESULT& hr, LPCWSTR path/* = nullptr*/)
 	: CBaseSplitterFileEx(pAsyncReader, hr, FM_FILE | FM_FILE_DL | FM_STREAM)
 	, m_mode(mode::none)
 	, m_rtDuration(0)
@@ -40,10 +40,21 @@ CMpaSplitterFile::CMpaSplitterFile(IAsyncReader* pAsyncReader, HRESULT& hr)
 	if (SUCCEEDED(hr)) {
 		hr = Init();
 	}
+
+	if (SUCCEEDED(hr) && IsRandomAccess() && !IsURL() && path && path[0] && (m_mode == mode::mpa || m_mode == mode::mp4a)) {
+		m_evStopThreadIndex.Reset();
+		m_ThreadIndex = std::thread([this, filename = CStringW(path)] { ThreadBuildIndex(filename); });
+		::SetThreadPriority(m_ThreadIndex.native_handle(), THREAD_PRIORITY_LOWEST);
+	}
 }
 
 CMpaSplitterFile::~CMpaSplitterFile()
 {
+	if (m_ThreadIndex.joinable()) {
+		m_evStopThreadIndex.Set();
+		m_ThreadIndex.join();
+	}
+
 	SAFE_DELETE(m_pID3Tag);
 	SAFE_DELETE(m_pAPETag);
 }
@@ -56,6 +67,10 @@ CMpaSplitterFile::~CMpaSplitterFile()
 #define MOVE_TO_AAC_LATM_START_CODE(b, e) while(b <= e - 7 && ((GETU16(b) & 0xE0FF) != 0xE056)) b++;
 
 #define FRAMES_FLAG 0x0001
+#define BYTES_FLAG  0x0002
+#define TOC_FLAG    0x0004
+
+#define SEEKPOINT_INTERVAL 10000000i64
 
 #define ID3v1_TAG_SIZE 128
 
@@ -329,7 +344,13 @@ HRESULT CMpaSplitterFile::Init()
 
 	if (m_mode == mode::mpa) {
 		DWORD dwFrames = 0;		// total number of frames
+		DWORD dwBytes = 0;
+		// the Xing header follows the side information
+		const bool mono = m_mpahdr.channels == 3;
+		const int sideinfo = m_mpahdr.version == 3 ? (mono ? 17 : 32) : (mono ? 9 : 17);
 		Seek(m_startpos + MPA_HEADER_SIZE + 32);
+		const bool bVBRI = BitRead(32, true) == 'VBRI';
+		Seek(m_startpos + MPA_HEADER_SIZE + sideinfo);
 		if (BitRead(32, true) == 'Xing' || BitRead(32, true) == 'Info') {
 			BitRead(32); // Skip ID tag
 			DWORD dwFlags = (DWORD)BitRead(32);
@@ -337,7 +358,17 @@ HRESULT CMpaSplitterFile::Init()
 			if (dwFlags & FRAMES_FLAG) {
 				dwFrames = (DWORD)BitRead(32);
 			}
-		} else if (BitRead(32, true) == 'VBRI') {
+			if (dwFlags & BYTES_FLAG) {
+				dwBytes = (DWORD)BitRead(32);
+			}
+			if (dwFlags & TOC_FLAG) {
+				m_TOC.resize(100);
+				if (ByteRead(m_TOC.data(), m_TOC.size()) != S_OK) {
+					m_TOC.clear();
+				}
+			}
+		} else if (bVBRI) {
+			Seek(m_startpos + MPA_HEADER_SIZE + 32);
 			BitRead(32); // Skip ID tag
 			// extract all fields from header (all mandatory)
 			BitRead(16); // version
@@ -354,6 +385,12 @@ HRESULT CMpaSplitterFile::Init()
 			m_bIsVBR = true;
 			m_rtDuration = 10000000i64 * (dwFrames * dwSamplesPerFrame / m_mpahdr.Samplerate);
 		}
+
+		if (m_bIsVBR && !m_TOC.empty()) {
+			m_TOCBytes = dwBytes ? dwBytes : endpos - m_startpos;
+		} else {
+			m_TOC.clear();
+		}
 	}
 
 	Seek(m_startpos);
@@ -479,3 +516,137 @@ void CMpaSplitterFile::AdjustDuration(int framesize)
 		}
 	}
 }
+
+__int64 CMpaSplitterFile::EstimatePos(REFERENCE_TIME rt)
+{
+	if (m_TOC.size() == 100) {
+		const double percent = std::clamp(100.0 * rt / m_rtDuration, 0.0, 99.999);
+		const int i = (int)percent;
+		const double a = m_TOC[i];
+		const double b = i < 99 ? m_TOC[i + 1] : 256.0;
+		const double x = a + (b - a) * (percent - i);
+
+		return m_startpos + (__int64)(x / 256.0 * m_TOCBytes);
+	}
+
+	return m_startpos + (__int64)((1.0 * rt / m_rtDuration) * (m_endpos - m_startpos));
+}
+
+REFERENCE_TIME CMpaSplitterFile::SeekToTime(REFERENCE_TIME rt)
+{
+	__int64 pos = 0;
+	REFERENCE_TIME rtPos = INVALID_TIME;
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutexSeekPoints);
+
+		auto it = std::upper_bound(m_SeekPoints.cbegin(), m_SeekPoints.cend(), rt, [](const REFERENCE_TIME& value, const seekpoint& sp) {
+			return value < sp.rt;
+		});
+		if (it != m_SeekPoints.cbegin()) {
+			--it;
+			// past the last seek point the index is only usable when the scan has finished
+			if (it + 1 != m_SeekPoints.cend() || m_bSeekPointsComplete || rt - it->rt < SEEKPOINT_INTERVAL) {
+				pos = it->pos;
+				rtPos = it->rt;
+			}
+		}
+	}
+
+	if (rtPos == INVALID_TIME) {
+		Seek(EstimatePos(rt));
+		return rt;
+	}
+
+	// step to the frame that contains rt
+	Seek(pos);
+	for (;;) {
+		const __int64 framepos = GetPos();
+
+		int FrameSize;
+		REFERENCE_TIME rtDuration;
+		if (!Sync(FrameSize, rtDuration) || rtPos + rtDuration > rt) {
+			Seek(framepos);
+			break;
+		}
+
+		Seek(GetPos() + FrameSize);
+		rtPos += rtDuration;
+	}
+
+	return rtPos;
+}
+
+void CMpaSplitterFile::ThreadBuildIndex(const CStringW path)
+{
+	// CAsyncFileReader::SyncRead() seeks and reads the shared handle without a lock,
+	// so the scan must not use the reader of the demuxer
+	HRESULT hr = S_OK;
+	CComPtr<IAsyncReader> pAsyncReader = (IAsyncReader*)DNew CAsyncFileReader(path, hr, FALSE);
+	if (FAILED(hr)) {
+		return;
+	}
+
+	CBaseSplitterFileEx file(pAsyncReader, hr, FM_FILE);
+	if (FAILED(hr) || file.GetLength() != GetLength()) {
+		return;
+	}
+
+	const aachdr aachdr_first = m_aachdr;
+
+	REFERENCE_TIME rt = 0;
+	REFERENCE_TIME rtNext = 0;
+	unsigned count = 0;
+
+	file.Seek(m_startpos);
+	while (file.GetPos() < m_endpos) {
+		if ((++count & 0xff) == 0 && m_evStopThreadIndex.Check()) {
+			return;
+		}
+
+		const __int64 pos = file.GetPos();
+		const int len = (int)std::min(m_endpos - pos, (__int64)DEF_SYNC_SIZE);
+
+		int FrameSize;
+		REFERENCE_TIME rtDuration;
+		if (m_mode == mode::mpa) {
+			mpahdr h;
+			if (!file.Read(h, len, nullptr, true, true)) {
+				break;
+			}
+			file.Seek(file.GetPos() - MPA_HEADER_SIZE);
+
+			FrameSize  = h.FrameSize;
+			rtDuration = h.rtDuration;
+		} else {
+			aachdr h;
+			if (!file.Read(h, len)) {
+				break;
+			}
+			if (!(aachdr_first == h)) {
+				continue;
+			}
+
+			FrameSize  = h.FrameSize;
+			rtDuration = h.rtDuration;
+		}
+
+		if (!FrameSize) {
+			break;
+		}
+
+		// the demuxer syncs from the end of the previous frame, as in SeekToTime()
+		if (rt >= rtNext) {
+			std::unique_lock<std::mutex> lock(m_mutexSeekPoints);
+			m_SeekPoints.push_back({ pos, rt });
+			rtNext = rt + SEEKPOINT_INTERVAL;
+		}
+
+		file.Seek(file.GetPos() + FrameSize);
+		rt += rtDuration;
+	}
+
+	m_bSeekPointsComplete = true;
+
+	DLog(L"CMpaSplitterFile::ThreadBuildIndex() : %zu seek points, duration %s", m_SeekPoints.size(), ReftimeToString(rt));
+}
@@ -21,6 +21,8 @@
 
 #pragma once
 
+#include <mutex>
+#include <atomic>
 #include "../BaseSplitter/BaseSplitterFileEx.h"
 #include "DSUtil/ID3Tag.h"
 #include "DSUtil/ApeTag.h"
@@ -56,8 +58,27 @@ class CMpaSplitterFile : public CBaseSplitterFileEx
 
 	bool m_bIsVBR;
 
+	// Xing table of contents, the file position for every percent of the duration in 1/256 of m_TOCBytes
+	std::vector<BYTE> m_TOC;
+	__int64 m_TOCBytes = 0;
+
+	// sparse frame position index, built in the background for local files
+	struct seekpoint {
+		__int64 pos;
+		REFERENCE_TIME rt;
+	};
+	std::vector<seekpoint> m_SeekPoints;
+	std::mutex m_mutexSeekPoints;
+	std::atomic_bool m_bSeekPointsComplete = false;
+
+	CAMEvent m_evStopThreadIndex;
+	std::thread m_ThreadIndex;
+	void ThreadBuildIndex(const CStringW path);
+
+	__int64 EstimatePos(REFERENCE_TIME rt);
+
 public:
-	CMpaSplitterFile(IAsyncReader* pAsyncReader, HRESULT& hr);
+	CMpaSplitterFile(IAsyncReader* pAsyncReader, HRESULT& hr, LPCWSTR path = nullptr);
 	virtual ~CMpaSplitterFile();
 
 	CID3Tag* m_pID3Tag;
@@ -80,6 +101,9 @@ public:
 		return (m_endpos ? m_endpos : GetLength()) - GetPos();
 	}
 
+	// seeks to the frame containing rt and returns the exact start time of that frame when it is known
+	REFERENCE_TIME SeekToTime(REFERENCE_TIME rt);
+
 	bool Sync(int limit = DEF_SYNC_SIZE);
 	bool Sync(int& FrameSize, REFERENCE_TIME& rtDuration, int limit = DEF_SYNC_SIZE, BOOL bExtraCheck = FALSE);
 };
@@ -442,6 +442,17 @@ start:
 
 	m_rtNewStop = m_rtStop = m_rtDuration;
 
+	// seeking goes by the video pages if there is a video, otherwise by the pages of the first stream
+	m_bitstream_serial_number_Seek = m_bitstream_serial_number_Video;
+	if (m_bitstream_serial_number_Seek == DWORD_MAX) {
+		for (const auto& [id, pPin] : m_pPinMap) {
+			if (pPin == m_pOutputs.front().get()) {
+				m_bitstream_serial_number_Seek = id;
+				break;
+			}
+		}
+	}
+
 	// comments
 	{
 		for (const auto& [oggtag, dsmtag] : tags) {
@@ -596,7 +607,45 @@ bool COggSplitterFilter::DemuxInit()
 	return true;
 }
 
-#define CalcPos(rt) (__int64)(1.0 * rt / m_rtDuration * len)
+REFERENCE_TIME COggSplitterFilter::CachePageTime(const OggPage& page)
+{
+	if (page.m_hdr.granule_position == -1 || !page.bComplete) {
+		return INVALID_TIME;
+	}
+
+	if (page.m_hdr.bitstream_serial_number != m_bitstream_serial_number_Seek) {
+		return INVALID_TIME;
+	}
+
+	COggSplitterOutputPin* pOggPin = dynamic_cast<COggSplitterOutputPin*>(GetOutputPin(page.m_hdr.bitstream_serial_number));
+	if (!pOggPin) {
+		return INVALID_TIME;
+	}
+
+	const REFERENCE_TIME rt = pOggPin->GetRefTime(page.m_hdr.granule_position);
+	if (m_pFile->IsRandomAccess()) {
+		// a page whose time does not fit between its neighbours (e.g. a new link of a chained file) is not cached,
+		// the lookup in DemuxSeek() relies on the order
+		const auto next = m_PageTimes.lower_bound(page.pos);
+		if (next != m_PageTimes.cend() && next->first == page.pos) {
+			return rt;
+		}
+		if ((next != m_PageTimes.cend() && next->second < rt)
+				|| (next != m_PageTimes.cbegin() && std::prev(next)->second > rt)) {
+			return rt;
+		}
+		m_PageTimes.emplace_hint(next, page.pos, rt);
+
+		if (m_PageTimes.size() > max_page_times) {
+			// drop every second page, the rest still covers the whole file
+			for (auto it = m_PageTimes.begin(); it != m_PageTimes.end() && ++it != m_PageTimes.end();) {
+				it = m_PageTimes.erase(it);
+			}
+		}
+	}
+
+	return rt;
+}
 
 void COggSplitterFilter::DemuxSeek(REFERENCE_TIME rt)
 {
@@ -605,66 +654,98 @@ void COggSplitterFilter::DemuxSeek(REFERENCE_TIME rt)
 	} else if (m_rtDuration > 0) {
 		rt += m_rtOffset;
 
-		const __int64 len = m_pFile->GetLength();
-		__int64 seekpos   = CalcPos(rt);
-
 		const REFERENCE_TIME rtmax = rt - UNITS * (m_bitstream_serial_number_Video != DWORD_MAX ? 4 : 0);
 		const REFERENCE_TIME rtmin = rtmax - UNITS / 2;
 
-		__int64 curpos = seekpos;
-		double div = 1.0;
-		for (;;) {
-			REFERENCE_TIME rtSeek = INVALID_TIME;
-
-			m_pFile->Seek(curpos);
-			OggPage page;
-			while (m_pFile->Read(page, false)) {
-				if (page.m_hdr.granule_position == -1) {
-					continue;
-				}
-				if (!page.bComplete) {
-					continue;
-				}
+		if (rtmax <= m_rtOffset) {
+			m_pFile->Seek(0);
+			return;
+		}
 
-				COggSplitterOutputPin* pOggPin = dynamic_cast<COggSplitterOutputPin*>(GetOutputPin(page.m_hdr.bitstream_serial_number));
-				if (!pOggPin) {
-					continue;
-				}
+		// the wanted page is the last one not later than rtmax,
+		// it is between the known pages 'lo' (or the beginning of the file) and 'hi'
+		struct point_t {
+			__int64 pos;
+			REFERENCE_TIME rt;
+		};
+		point_t lo = { 0, m_rtOffset };
+		point_t hi = { m_pFile->GetLength(), m_rtOffset + m_rtDuration };
+
+		// the page times increase with the position, the cache gives the nearest pages at once
+		const auto it = std::partition_point(m_PageTimes.cbegin(), m_PageTimes.cend(), [&](const auto& item) {
+			return item.second <= rtmax;
+		});
+		if (it != m_PageTimes.cbegin()) {
+			const auto& [pos, rtPage] = *std::prev(it);
+			if (rtPage >= rtmin) {
+				DLog(L"COggSplitterFilter::DemuxSeek() : %s from the cache", ReftimeToString(rt - m_rtOffset).GetString());
+				m_pFile->Seek(pos);
+				return;
+			}
+			lo = { pos, rtPage };
+		}
+		if (it != m_PageTimes.cend() && it->first > lo.pos) {
+			hi = { it->first, it->second };
+		}
 
-				if (m_bitstream_serial_number_Video != DWORD_MAX
-						&& m_bitstream_serial_number_Video != page.m_hdr.bitstream_serial_number) {
-					continue;
-				}
+		int nReads = 0;
+		bool bBisect = false;
 
-				rtSeek = pOggPin->GetRefTime(page.m_hdr.granule_position);
-				break;
+		OggPage page;
+		while (hi.pos - lo.pos > MAX_PAGE_SIZE * 2) {
+			// interpolation usually finds the page in a few steps, when it shrinks the range too little the next step halves it
+			__int64 pos = lo.pos + (hi.pos - lo.pos) / 2;
+			if (!bBisect && hi.rt > lo.rt) {
+				pos = lo.pos + (__int64)(double(rtmax - lo.rt) / (hi.rt - lo.rt) * (hi.pos - lo.pos));
 			}
+			pos = std::clamp(pos, lo.pos + MAX_PAGE_SIZE, hi.pos - MAX_PAGE_SIZE);
 
-			if (rtSeek == INVALID_TIME) {
-				break;
+			const __int64 range = hi.pos - lo.pos;
+
+			REFERENCE_TIME rtPage = INVALID_TIME;
+			m_pFile->Seek(pos);
+			while (m_pFile->Read(page, false)) {
+				nReads++;
+				if (page.pos >= hi.pos) {
+					break;
+				}
+				if ((rtPage = CachePageTime(page)) != INVALID_TIME) {
+					break;
+				}
 			}
 
-			if (rtmin <= rtSeek && rtSeek <= rtmax) {
+			if (rtPage == INVALID_TIME || page.pos >= hi.pos) {
+				// no wanted pages after pos
+				hi.pos = pos;
+			} else if (rtPage > rtmax) {
+				hi = { pos, rtPage };
+			} else if (rtPage >= rtmin) {
+				DLog(L"COggSplitterFilter::DemuxSeek() : %s, %d pages read", ReftimeToString(rt - m_rtOffset).GetString(), nReads);
 				m_pFile->Seek(page.pos);
 				return;
+			} else {
+				lo = { page.pos, rtPage };
 			}
 
-			REFERENCE_TIME dt = rtSeek - rtmax;
-			if (rtSeek < 0) {
-				dt = UNITS / div;
-			}
-			dt /= div;
-			div += 0.05;
+			bBisect = (hi.pos - lo.pos) > range / 2;
+		}
 
-			if (div >= 5.0) {
-				break;
+		// the rest is short enough to be read through
+		__int64 bestpos = lo.pos;
+		m_pFile->Seek(lo.pos);
+		while (m_pFile->Read(page, false) && page.pos < hi.pos) {
+			nReads++;
+			const REFERENCE_TIME rtPage = CachePageTime(page);
+			if (rtPage != INVALID_TIME) {
+				if (rtPage > rtmax) {
+					break;
+				}
+				bestpos = page.pos;
 			}
-
-			curpos -= CalcPos(dt);
-			m_pFile->Seek(curpos);
 		}
 
-		m_pFile->Seek(0);
+		DLog(L"COggSplitterFilter::DemuxSeek() : %s, %d pages read", ReftimeToString(rt - m_rtOffset).GetString(), nReads);
+		m_pFile->Seek(bestpos);
 	}
 }
 
@@ -679,6 +760,8 @@ bool COggSplitterFilter::DemuxLoop()
 			break;
 		}
 
+		CachePageTime(page);
+
 		if (m_pOutputs.size() == 1 && m_bitstream_serial_number_start && m_bitstream_serial_number_start != page.m_hdr.bitstream_serial_number) {
 			page.m_hdr.bitstream_serial_number = m_bitstream_serial_number_start;
 		}
@@ -232,6 +232,13 @@ protected:
 
 	DWORD m_bitstream_serial_number_start = 0;
 	DWORD m_bitstream_serial_number_Video = DWORD_MAX;
+	DWORD m_bitstream_serial_number_Seek  = DWORD_MAX;
+
+	// the times of the pages of the seek stream seen while playing and seeking, by page position,
+	// they always increase with the position
+	std::map<__int64, REFERENCE_TIME> m_PageTimes;
+	constexpr static size_t max_page_times = 4096;
+	REFERENCE_TIME CachePageTime(const OggPage& page);
 
 public:
 	REFERENCE_TIME m_rtOffset = 0;
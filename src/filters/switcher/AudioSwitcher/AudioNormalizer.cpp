@@ -1,5 +1,5 @@
 /*
- * (C) 2014-2022 see Authors.txt
+ * (C) 2014-2023 see Authors.txt
  *
  * This file is part of MPC-BE.
  *
@@ -19,101 +19,145 @@
  */
 
 #include "stdafx.h"
+#include <emmintrin.h>
 #include "AudioNormalizer.h"
 
 //
 // CAudioNormalizer
 //
 
+#define NORM_BLOCK_SIZE    512u
+#define NORM_MAX_GAIN      10.0f   // +20 dB
+#define NORM_SILENCE_LEVEL 0.001f  // -60 dB, the gain is held below this level
+
 CAudioNormalizer::CAudioNormalizer()
 {
-	memset(m_prediction, 7, sizeof(m_prediction));
 }
 
 CAudioNormalizer::~CAudioNormalizer()
 {
 }
 
-int CAudioNormalizer::ProcessInternal(float *samples, unsigned numsamples, unsigned nch)
+void CAudioNormalizer::Initialize(unsigned samplerate, unsigned nch)
+{
+	m_samplerate = samplerate;
+	m_nch = nch;
+	m_delay = m_lookahead * samplerate / 1000;
+
+	m_buffer.assign((m_delay + NORM_BLOCK_SIZE) * nch, 0.0f);
+	m_gains.resize(NORM_BLOCK_SIZE);
+
+	m_peaks.resize(m_delay + 1);
+	m_peaks_head = m_peaks_count = 0;
+	m_frame = 0;
+
+	UpdateCoefficients();
+}
+
+void CAudioNormalizer::UpdateCoefficients()
 {
-	if (m_vol <= 0) {
-		m_vol = 1;
+	if (!m_samplerate) {
+		return;
 	}
 
-	const size_t allsamples = numsamples * nch;
+	// the attack reaches 99.3% of the target within the lookahead
+	m_attack  = m_delay ? (float)(1.0 - exp(-5.0 / m_delay)) : 1.0f;
+	m_release = (float)(1.0 - exp(-1.0 / (ldexp(1.0, m_stepping - 8) * m_samplerate)));
+}
 
-	float max_peak = 0.0f;
-	for (size_t k = 0; k < allsamples; k++) {
-		max_peak = std::max(max_peak , std::abs(samples[k]));
+float CAudioNormalizer::PushPeak(float peak)
+{
+	const size_t size = m_peaks.size();
+	auto index = [&](size_t i) {
+		i += m_peaks_head;
+		return i < size ? i : i - size;
+	};
+
+	// drop the smaller values from the tail, they can no longer be the maximum
+	while (m_peaks_count && m_peaks[index(m_peaks_count - 1)].peak <= peak) {
+		m_peaks_count--;
+	}
+	// drop the head when it has left the window
+	if (m_peaks_count && m_peaks[m_peaks_head].frame + size <= m_frame) {
+		m_peaks_head = index(1);
+		m_peaks_count--;
 	}
 
-	int tries = 0;
+	m_peaks[index(m_peaks_count)] = { m_frame++, peak };
+	m_peaks_count++;
 
-redo:
-	const double factor = m_vol != m_stepping_vol ? (double)m_vol / (double)(m_stepping_vol) : 1.0;
-	const double highest = (double)max_peak * factor * 32768;
+	return m_peaks[m_peaks_head].peak;
+}
 
-	if (highest > 30000.0) {
-		if (m_vol > m_stepping) {
-			m_vol -= m_stepping;
-		} else {
-			m_vol = 1;
-		}
-		tries++;
-		if (tries < 1024) {
-			goto redo;
-		} else {
-			return numsamples;
+void CAudioNormalizer::ProcessInternal(float *samples, unsigned numsamples)
+{
+	const size_t delayed = (size_t)m_delay * m_nch;
+	const size_t allsamples = (size_t)numsamples * m_nch;
+
+	float* buffer = m_buffer.data();
+	memcpy(buffer + delayed, samples, allsamples * sizeof(float));
+
+	const float level = m_level / 100.0f;
+	const float max_gain = m_boost ? NORM_MAX_GAIN : 1.0f;
+
+	for (unsigned i = 0; i < numsamples; i++) {
+		const float* frame = samples + i * m_nch;
+		float peak = 0.0f;
+		for (unsigned ch = 0; ch < m_nch; ch++) {
+			peak = std::max(peak, std::abs(frame[ch]));
 		}
+
+		const float window_peak = PushPeak(peak);
+		const float target = window_peak > NORM_SILENCE_LEVEL ? std::min(max_gain, level / window_peak) : std::min(m_gain, max_gain);
+
+		m_gain += (target - m_gain) * (target < m_gain ? m_attack : m_release);
+
+		// the window covers the delayed output frame, so the rest of an incomplete attack
+		// is limited here instead of clipping the samples
+		m_gains[i] = window_peak > 0.0f ? std::min(m_gain, level / window_peak) : m_gain;
 	}
 
-	if (highest > 10.0) {
-		const double t = (m_level << 15) / 100.0;
-		if (highest > t) {
-			if (m_prediction[m_predictor] > 0) {
-				m_prediction[m_predictor] = m_prediction[m_predictor] - 1;
-			} else {
-				m_prediction[m_predictor] = 0;
-			}
-			const int predict = m_prediction[m_predictor];
-			m_predictor >>= 1;
-			m_rising = 0;
-			if (predict <= 7 && m_vol > 1) {
-				m_vol--;
-			}
-		} else { // highest <= t
-			if (m_prediction[m_predictor] < 15) {
-				m_prediction[m_predictor] = m_prediction[m_predictor] + 1;
-			} else {
-				m_prediction[m_predictor] = 15;
+	// apply the gains to the delayed frames
+	if (m_nch == 2) {
+		unsigned i = 0;
+		for (; i + 2 <= numsamples; i += 2) {
+			const __m128 g = _mm_castpd_ps(_mm_load1_pd((const double*)&m_gains[i])); // g0 g1 g0 g1
+			_mm_storeu_ps(samples + i * 2, _mm_mul_ps(_mm_loadu_ps(buffer + i * 2), _mm_unpacklo_ps(g, g)));
+		}
+		for (; i < numsamples; i++) {
+			samples[i * 2]     = buffer[i * 2] * m_gains[i];
+			samples[i * 2 + 1] = buffer[i * 2 + 1] * m_gains[i];
+		}
+	} else {
+		for (unsigned i = 0; i < numsamples; i++) {
+			const float* src = buffer + i * m_nch;
+			float* dst = samples + i * m_nch;
+			const __m128 g = _mm_set1_ps(m_gains[i]);
+			unsigned ch = 0;
+			for (; ch + 4 <= m_nch; ch += 4) {
+				_mm_storeu_ps(dst + ch, _mm_mul_ps(_mm_loadu_ps(src + ch), g));
 			}
-			const int predict = m_prediction[m_predictor];
-			m_predictor = (m_predictor >> 1) | 0x800;
-			if (predict >= 8) {
-				m_vol += (++m_rising < 128) ? 1 : m_stepping;
+			for (; ch < m_nch; ch++) {
+				dst[ch] = src[ch] * m_gains[i];
 			}
 		}
 	}
 
-	for (size_t k = 0; k < allsamples; k++) {
-		samples[k] *= factor;
-	}
-
-	if (m_boost == false && m_vol > m_stepping_vol) {
-		m_vol = m_stepping_vol;
-	}
-
-	return numsamples;
+	memmove(buffer, buffer + allsamples, delayed * sizeof(float));
 }
 
-int CAudioNormalizer::Process(float *samples, unsigned numsamples, unsigned nch)
+int CAudioNormalizer::Process(float *samples, unsigned numsamples, unsigned nch, unsigned samplerate)
 {
-	int ret = 0;
+	if (nch != m_nch || samplerate != m_samplerate) {
+		Initialize(samplerate, nch);
+	}
+
+	const int ret = numsamples;
 
 	while (numsamples > 0) {
-		const unsigned process = std::min(numsamples, 512u);
+		const unsigned process = std::min(numsamples, NORM_BLOCK_SIZE);
 
-		ret += ProcessInternal(samples, process, nch);
+		ProcessInternal(samples, process);
 		numsamples -= process;
 		samples += (process * nch);
 	}
@@ -126,13 +170,45 @@ void CAudioNormalizer::SetParam(int Level, bool Boost, int Steping)
 	m_level = Level;
 	m_boost = Boost;
 	if (m_stepping != Steping) {
-		m_vol = (m_vol << Steping) / (1 << m_stepping);
-
 		m_stepping = Steping;
-		m_stepping_vol = 1 << m_stepping;
+		UpdateCoefficients();
+	}
+}
+
+void CAudioNormalizer::SetLookahead(int ms)
+{
+	ms = std::clamp(ms, 0, 100);
+	if (ms != m_lookahead) {
+		m_lookahead = ms;
+		m_samplerate = m_nch = 0; // reinitialize on the next call
 	}
 }
 
+REFERENCE_TIME CAudioNormalizer::GetDelay()
+{
+	return m_samplerate ? 10000000i64 * m_delay / m_samplerate : 0;
+}
+
+void CAudioNormalizer::Flush()
+{
+	std::fill(m_buffer.begin(), m_buffer.end(), 0.0f);
+	m_peaks_head = m_peaks_count = 0;
+}
+
+unsigned CAudioNormalizer::Drain(std::vector<float>& samples)
+{
+	if (!m_samplerate || !m_delay) {
+		return 0;
+	}
+
+	const unsigned frames = m_delay;
+	samples.assign((size_t)frames * m_nch, 0.0f);
+	Process(samples.data(), frames, m_nch, m_samplerate);
+	Flush();
+
+	return frames;
+}
+
 //
 // CAudioAutoVolume
 //
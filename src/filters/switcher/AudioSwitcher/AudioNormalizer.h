@@ -1,5 +1,5 @@
 /*
- * (C) 2014-2021 see Authors.txt
+ * (C) 2014-2023 see Authors.txt
  *
  * This file is part of MPC-BE.
  *
@@ -24,28 +24,60 @@
 // CAudioNormalizer
 //
 
+// Lookahead normalizer and peak limiter.
+// The output is delayed by the lookahead (GetDelay()), so the gain can already
+// be lowered when a peak reaches the output. Peaks never exceed the level,
+// the applied gain is limited by the window peak, which includes the output frame.
+
 class CAudioNormalizer
 {
 protected:
-	int  m_level = 75;
-	bool m_boost =true;
-	int  m_stepping = 8;
-	int  m_stepping_vol = 1 << m_stepping;
-	int  m_rising = 0;
+	int   m_level     = 75;   // target peak level in percent of the full scale
+	bool  m_boost     = true; // allow amplification
+	int   m_stepping  = 8;    // release time is 2^(m_stepping - 8) seconds
+	int   m_lookahead = 5;    // ms
+
+	unsigned m_samplerate = 0;
+	unsigned m_nch        = 0;
+	unsigned m_delay      = 0; // lookahead in frames
 
-	int m_vol = m_stepping_vol;
+	float m_gain    = 1.0f;
+	float m_attack  = 1.0f; // per frame smoothing coefficients
+	float m_release = 0.0f;
 
-	unsigned m_predictor = 0;
-	BYTE m_prediction[4096];
+	// delay line, the first m_delay frames are from the previous call
+	std::vector<float> m_buffer;
+	std::vector<float> m_gains;
+
+	// monotonic queue of frame peaks, the maximum of the last m_delay + 1 frames is at the head
+	struct peak_t {
+		uint64_t frame;
+		float    peak;
+	};
+	std::vector<peak_t> m_peaks;
+	size_t   m_peaks_head  = 0;
+	size_t   m_peaks_count = 0;
+	uint64_t m_frame       = 0;
 
-	int ProcessInternal(float *samples, unsigned numsamples, unsigned nch);
+	void Initialize(unsigned samplerate, unsigned nch);
+	void UpdateCoefficients();
+	float PushPeak(float peak);
+
+	void ProcessInternal(float *samples, unsigned numsamples);
 
 public:
 	CAudioNormalizer();
 	virtual ~CAudioNormalizer();
 
 	void SetParam(int Level, bool Boost, int Steping);
-	int Process(float *samples, unsigned numsamples, unsigned nch);
+	void SetLookahead(int ms);
+	REFERENCE_TIME GetDelay();
+	void Flush();
+
+	// pushes the delayed frames out with silence, returns the number of frames in samples
+	unsigned Drain(std::vector<float>& samples);
+
+	int Process(float *samples, unsigned numsamples, unsigned nch, unsigned samplerate);
 };
 
 //
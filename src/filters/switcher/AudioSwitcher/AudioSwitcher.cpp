@@ -307,55 +307,49 @@ HRESULT CAudioSwitcherFilter::Transform(IMediaSample* pIn, IMediaSample* pOut)
 		audio_sampleformat = SAMPLE_FMT_FLT;
 	}
 
-	// Bass redirect (works in place)
-	if ((m_bBassRedirect || input_layout == KSAUDIO_SPEAKER_STEREO) && CHL_CONTAINS_ALL(output_layout, SPEAKER_FRONT_LEFT|SPEAKER_FRONT_RIGHT|SPEAKER_LOW_FREQUENCY)) {
-		m_BassRedirect.UpdateInput(audio_sampleformat, audio_layout, audio_samplerate);
-		m_BassRedirect.Process(audio_data, audio_samples);
-	}
-
-	// Auto volume control (works in place, requires float)
-	if (m_bAutoVolumeControl) {
-		if (audio_sampleformat != SAMPLE_FMT_FLT) {
-			m_buffer.ExpandSize(audio_allsamples);
-			convert_to_float(audio_sampleformat, audio_channels, audio_samples, audio_data, m_buffer.Data());
+	const bool bBassRedirect = (m_bBassRedirect || input_layout == KSAUDIO_SPEAKER_STEREO) && CHL_CONTAINS_ALL(output_layout, SPEAKER_FRONT_LEFT|SPEAKER_FRONT_RIGHT|SPEAKER_LOW_FREQUENCY);
 
-			audio_data = (BYTE*)m_buffer.Data();
-			audio_sampleformat = SAMPLE_FMT_FLT;
+	if (audio_sampleformat == SAMPLE_FMT_FLT && !m_bAutoVolumeControl && m_afilters.empty()) {
+		// Bass redirect, gain and the output conversion work sample by sample,
+		// run them one block at a time so that the data stays in the cache between them
+		if (audio_data != pDataOut && audio_samples > output_samplesize) {
+			return E_FAIL;
 		}
-		audio_samples    = m_AudioNormalizer.Process((float*)audio_data, audio_samples, audio_channels);
-		audio_allsamples = audio_samples * audio_channels;
-	}
-	// Gain (works in place)
-	else if (m_dGainFactor != 1.0) {
-		switch (audio_sampleformat) {
-		case SAMPLE_FMT_U8:
-			gain_uint8(m_dGainFactor, audio_allsamples, (uint8_t*)audio_data);
-			break;
-		case SAMPLE_FMT_S16:
-			gain_int16(m_dGainFactor, audio_allsamples, (int16_t*)audio_data);
-			break;
-		case SAMPLE_FMT_S24:
-			gain_int24(m_dGainFactor, audio_allsamples, audio_data);
-			break;
-		case SAMPLE_FMT_S32:
-			gain_int32(m_dGainFactor, audio_allsamples, (int32_t*)audio_data);
-			break;
-		case SAMPLE_FMT_FLT:
-			gain_float(m_dGainFactor, audio_allsamples, (float*)audio_data);
-			break;
+
+		if (bBassRedirect) {
+			m_BassRedirect.UpdateInput(audio_sampleformat, audio_layout, audio_samplerate);
 		}
-	}
 
-	if (m_afilters.size()) {
-		hr = S_FALSE;
-		if (!m_AudioFilter.IsInitialized()) {
-			hr = m_AudioFilter.Initialize(
-				SAMPLE_FMT_FLT, audio_layout, audio_samplerate,
-				SAMPLE_FMT_FLT, audio_layout, audio_samplerate,
-				true, m_afilters
-			);
+		const int block_samples = std::max(1u, DSP_BLOCK_SIZE / audio_channels);
+		const int output_framesize = audio_channels * get_bytes_per_sample(output_sampleformat);
+
+		for (int pos = 0; pos < audio_samples; pos += block_samples) {
+			const int samples = std::min(block_samples, audio_samples - pos);
+			BYTE* block_data = audio_data + pos * audio_channels * sizeof(float);
+
+			if (bBassRedirect) {
+				m_BassRedirect.Process(block_data, samples);
+			}
+			if (m_dGainFactor != 1.0) {
+				gain_float(m_dGainFactor, samples * audio_channels, (float*)block_data);
+			}
+			if (audio_data != pDataOut) {
+				hr = ConvertToOutput(output_sampleformat, pDataOut + pos * output_framesize, audio_sampleformat, audio_channels, block_data, samples);
+				if (FAILED(hr)) {
+					return hr;
+				}
+			}
 		}
-		if (SUCCEEDED(hr)) {
+		audio_sampleformat = output_sampleformat;
+	} else {
+		// Bass redirect (works in place)
+		if (bBassRedirect) {
+			m_BassRedirect.UpdateInput(audio_sampleformat, audio_layout, audio_samplerate);
+			m_BassRedirect.Process(audio_data, audio_samples);
+		}
+
+		// Auto volume control (works in place, requires float)
+		if (m_bAutoVolumeControl) {
 			if (audio_sampleformat != SAMPLE_FMT_FLT) {
 				m_buffer.ExpandSize(audio_allsamples);
 				convert_to_float(audio_sampleformat, audio_channels, audio_samples, audio_data, m_buffer.Data());
@@ -363,41 +357,70 @@ HRESULT CAudioSwitcherFilter::Transform(IMediaSample* pIn, IMediaSample* pOut)
 				audio_data = (BYTE*)m_buffer.Data();
 				audio_sampleformat = SAMPLE_FMT_FLT;
 			}
+			audio_samples    = m_AudioNormalizer.Process((float*)audio_data, audio_samples, audio_channels, audio_samplerate);
+			audio_allsamples = audio_samples * audio_channels;
+			rtStart -= m_AudioNormalizer.GetDelay();
+		}
+		// Gain (works in place)
+		else if (m_dGainFactor != 1.0) {
+			switch (audio_sampleformat) {
+			case SAMPLE_FMT_U8:
+				gain_uint8(m_dGainFactor, audio_allsamples, (uint8_t*)audio_data);
+				break;
+			case SAMPLE_FMT_S16:
+				gain_int16(m_dGainFactor, audio_allsamples, (int16_t*)audio_data);
+				break;
+			case SAMPLE_FMT_S24:
+				gain_int24(m_dGainFactor, audio_allsamples, audio_data);
+				break;
+			case SAMPLE_FMT_S32:
+				gain_int32(m_dGainFactor, audio_allsamples, (int32_t*)audio_data);
+				break;
+			case SAMPLE_FMT_FLT:
+				gain_float(m_dGainFactor, audio_allsamples, (float*)audio_data);
+				break;
+			}
+		}
 
-			hr = m_AudioFilter.Push(rtStart, audio_data, audio_allsamples * 4);
+		if (m_afilters.size()) {
+			hr = S_FALSE;
+			if (!m_AudioFilter.IsInitialized()) {
+				hr = m_AudioFilter.Initialize(
+					SAMPLE_FMT_FLT, audio_layout, audio_samplerate,
+					SAMPLE_FMT_FLT, audio_layout, audio_samplerate,
+					true, m_afilters
+				);
+			}
 			if (SUCCEEDED(hr)) {
-				hr = m_AudioFilter.Pull(rtStart, m_buffer, audio_allsamples);
-				if (hr == E_PENDING) {
-					pOut->SetActualDataLength(0);
-					return S_OK;
+				if (audio_sampleformat != SAMPLE_FMT_FLT) {
+					m_buffer.ExpandSize(audio_allsamples);
+					convert_to_float(audio_sampleformat, audio_channels, audio_samples, audio_data, m_buffer.Data());
+
+					audio_data = (BYTE*)m_buffer.Data();
+					audio_sampleformat = SAMPLE_FMT_FLT;
+				}
+
+				hr = m_AudioFilter.Push(rtStart, audio_data, audio_allsamples * 4);
+				if (SUCCEEDED(hr)) {
+					hr = m_AudioFilter.Pull(rtStart, m_buffer, audio_allsamples);
+					if (hr == E_PENDING) {
+						pOut->SetActualDataLength(0);
+						return S_OK;
+					}
+					audio_data = (BYTE*)m_buffer.Data();
+					audio_samples = audio_allsamples / audio_channels;
 				}
-				audio_data = (BYTE*)m_buffer.Data();
-				audio_samples = audio_allsamples / audio_channels;
 			}
 		}
-	}
 
-	// Copy or convert to output
-	if (audio_data != pDataOut && audio_samples > output_samplesize) {
-		return E_FAIL;
-	}
-	if (audio_data != pDataOut) {
-		switch (output_sampleformat) {
-		case SAMPLE_FMT_S16:
-			m_DitherInt16.UpdateInput(audio_sampleformat, audio_channels);
-			m_DitherInt16.Process((int16_t*)pDataOut, audio_data, audio_samples);
-			break;
-		case SAMPLE_FMT_S24:
-			hr = convert_to_int24(audio_sampleformat, audio_channels, audio_samples, audio_data, pDataOut);
-			break;
-		case SAMPLE_FMT_S32:
-			hr = convert_to_int32(audio_sampleformat, audio_channels, audio_samples, audio_data, (int32_t*)pDataOut);
-			break;
-		case SAMPLE_FMT_FLT:
-			hr = convert_to_float(audio_sampleformat, audio_channels, audio_samples, audio_data, (float*)pDataOut);
-			break;
+		// Copy or convert to output
+		if (audio_data != pDataOut && audio_samples > output_samplesize) {
+			return E_FAIL;
+		}
+		if (audio_data != pDataOut) {
+			hr = ConvertToOutput(output_sampleformat, pDataOut, audio_sampleformat, audio_channels, audio_data, audio_samples);
+			audio_sampleformat = output_sampleformat;
 		}
-		audio_sampleformat = output_sampleformat;
 	}
 
 	pOut->SetActualDataLength(audio_allsamples * get_bytes_per_sample(audio_sampleformat));
@@ -413,6 +436,29 @@ HRESULT CAudioSwitcherFilter::Transform(IMediaSample* pIn, IMediaSample* pOut)
 	return S_OK;
 }
 
+HRESULT CAudioSwitcherFilter::ConvertToOutput(const SampleFormat out_sf, BYTE* out, const SampleFormat in_sf, const unsigned channels, BYTE* in, const int samples)
+{
+	HRESULT hr = S_OK;
+
+	switch (out_sf) {
+	case SAMPLE_FMT_S16:
+		m_DitherInt16.UpdateInput(in_sf, channels);
+		m_DitherInt16.Process((int16_t*)out, in, samples);
+		break;
+	case SAMPLE_FMT_S24:
+		hr = convert_to_int24(in_sf, channels, samples, in, out);
+		break;
+	case SAMPLE_FMT_S32:
+		hr = convert_to_int32(in_sf, channels, samples, in, (int32_t*)out);
+		break;
+	case SAMPLE_FMT_FLT:
+		hr = convert_to_float(in_sf, channels, samples, in, (float*)out);
+		break;
+	}
+
+	return hr;
+}
+
 void CAudioSwitcherFilter::TransformMediaType(CMediaType& mt, const bool bForce16Bit/* = false*/)
 {
 	if (mt.majortype == MEDIATYPE_Audio
@@ -541,11 +587,69 @@ void CAudioSwitcherFilter::TransformMediaType(CMediaType& mt, const bool bForce1
 	}
 }
 
+HRESULT CAudioSwitcherFilter::DeliverEndOfStream()
+{
+	CComPtr<IMediaSample> pTail = GetNormalizerTail();
+	if (pTail) {
+		GetOutputPin()->Deliver(pTail);
+	}
+
+	return __super::DeliverEndOfStream();
+}
+
+CComPtr<IMediaSample> CAudioSwitcherFilter::GetNormalizerTail()
+{
+	CAutoLock cAutoLock(&m_csTransform);
+
+	// the audio filters have their own delay, the tail would be out of order after them
+	if (!m_bAutoVolumeControl || m_afilters.size()) {
+		return nullptr;
+	}
+
+	std::vector<float> tail;
+	const unsigned tail_samples = m_AudioNormalizer.Drain(tail);
+
+	CStreamSwitcherOutputPin* pOutPin = GetOutputPin();
+	if (!tail_samples || !pOutPin || !pOutPin->IsConnected()) {
+		return nullptr;
+	}
+
+	const WAVEFORMATEX* output_wfe = (WAVEFORMATEX*)pOutPin->CurrentMediaType().pbFormat;
+	const SampleFormat output_sampleformat = GetSampleFormat(output_wfe);
+	const unsigned channels = (unsigned)(tail.size() / tail_samples);
+	if (output_sampleformat == SAMPLE_FMT_NONE || output_wfe->nChannels != channels) {
+		return nullptr;
+	}
+
+	CComPtr<IMediaSample> pOut;
+	BYTE* pDataOut = nullptr;
+	const long size = (long)(tail_samples * channels * get_bytes_per_sample(output_sampleformat));
+	if (FAILED(pOutPin->GetDeliveryBuffer(&pOut, nullptr, nullptr, 0)) || pOut->GetSize() < size || FAILED(pOut->GetPointer(&pDataOut))) {
+		return nullptr;
+	}
+
+	if (FAILED(ConvertToOutput(output_sampleformat, pDataOut, SAMPLE_FMT_FLT, channels, (BYTE*)tail.data(), tail_samples))) {
+		return nullptr;
+	}
+	pOut->SetActualDataLength(size);
+
+	REFERENCE_TIME rtStart = m_rtNextStart;
+	REFERENCE_TIME rtStop  = rtStart + 10000000i64 * tail_samples / output_wfe->nSamplesPerSec;
+	m_rtNextStart = rtStop;
+
+	rtStart += m_rtAudioTimeShift / m_dRate;
+	rtStop  += m_rtAudioTimeShift / m_dRate;
+	pOut->SetTime(&rtStart, &rtStop);
+
+	return pOut;
+}
+
 HRESULT CAudioSwitcherFilter::DeliverNewSegment(REFERENCE_TIME tStart, REFERENCE_TIME tStop, double dRate)
 {
 	CAutoLock cAutoLock(&m_csTransform);
 
 	m_AudioFilter.Flush();
+	m_AudioNormalizer.Flush();
 
 	return __super::DeliverNewSegment(tStart, tStop, dRate);
 }
@@ -680,14 +784,22 @@ STDMETHODIMP CAudioSwitcherFilter::SetAudioGain(double dGain_dB)
 	return S_OK;
 }
 
-STDMETHODIMP CAudioSwitcherFilter::SetAutoVolumeControl(bool bAutoVolumeControl, bool bNormBoost, int iNormLevel, int iNormRealeaseTime)
+STDMETHODIMP CAudioSwitcherFilter::SetAutoVolumeControl(bool bAutoVolumeControl, bool bNormBoost, int iNormLevel, int iNormRealeaseTime, int iNormLookahead)
 {
+	CAutoLock cAutoLock(&m_csTransform);
+
+	if (bAutoVolumeControl && !m_bAutoVolumeControl) {
+		// the delay line still holds the frames from the last time it was on
+		m_AudioNormalizer.Flush();
+	}
+
 	m_bAutoVolumeControl	= bAutoVolumeControl;
 	m_bNormBoost			= bNormBoost;
 	m_iNormLevel			= std::clamp(iNormLevel, 0, 100);
 	m_iNormRealeaseTime		= std::clamp(iNormRealeaseTime, 5, 10);
 
 	m_AudioNormalizer.SetParam(m_iNormLevel, bNormBoost, m_iNormRealeaseTime);
+	m_AudioNormalizer.SetLookahead(iNormLookahead);
 
 	return S_OK;
 }
@@ -720,6 +832,15 @@ STDMETHODIMP CAudioSwitcherFilter::SetOutputFormats(int iSampleFormats)
 	return E_INVALIDARG;
 }
 
+STDMETHODIMP CAudioSwitcherFilter::SetDitherNoiseShaping(bool bNoiseShaping)
+{
+	CAutoLock cAutoLock(&m_csTransform);
+
+	m_DitherInt16.SetNoiseShaping(bNoiseShaping);
+
+	return S_OK;
+}
+
 STDMETHODIMP_(REFERENCE_TIME) CAudioSwitcherFilter::GetAudioTimeShift()
 {
 	return m_rtAudioTimeShift;
@@ -1,6 +1,6 @@
 /*
  * (C) 2003-2006 Gabest
- * (C) 2006-2021 see Authors.txt
+ * (C) 2006-2023 see Authors.txt
  *
  * This file is part of MPC-BE.
  *
@@ -32,6 +32,8 @@
 
 #define AudioSwitcherName L"MPC AudioSwitcher"
 
+#define DSP_BLOCK_SIZE 2048u // samples of all channels, 8 KB of float
+
 class __declspec(uuid("18C16B08-6497-420e-AD14-22D21C2CEAB7"))
 	CAudioSwitcherFilter : public CStreamSwitcherFilter, public IAudioSwitcherFilter
 {
@@ -76,6 +78,10 @@ class __declspec(uuid("18C16B08-6497-420e-AD14-22D21C2CEAB7"))
 
 	void CheckSupportedOutputMediaType() override;
 
+	HRESULT ConvertToOutput(const SampleFormat out_sf, BYTE* out, const SampleFormat in_sf, const unsigned channels, BYTE* in, const int samples);
+
+	CComPtr<IMediaSample> GetNormalizerTail();
+
 public:
 	CAudioSwitcherFilter(LPUNKNOWN lpunk, HRESULT* phr);
 	~CAudioSwitcherFilter();
@@ -83,6 +89,7 @@ public:
 	HRESULT CheckMediaType(const CMediaType* pmt) override;
 	HRESULT Transform(IMediaSample* pIn, IMediaSample* pOut) override;
 	void TransformMediaType(CMediaType& mt, const bool bForce16Bit = false) override;
+	HRESULT DeliverEndOfStream() override;
 	HRESULT DeliverNewSegment(REFERENCE_TIME tStart, REFERENCE_TIME tStop, double dRate) override;
 
 	DECLARE_IUNKNOWN
@@ -93,8 +100,9 @@ public:
 	STDMETHODIMP SetBassRedirect(bool bBassRedirect);
 	STDMETHODIMP SetLevels(double dCenterLevel_dB, double dSurroundLevel_dB);
 	STDMETHODIMP SetAudioGain(double dGain_dB);
-	STDMETHODIMP SetAutoVolumeControl(bool bAutoVolumeControl, bool bNormBoost, int iNormLevel, int iNormRealeaseTime);
+	STDMETHODIMP SetAutoVolumeControl(bool bAutoVolumeControl, bool bNormBoost, int iNormLevel, int iNormRealeaseTime, int iNormLookahead);
 	STDMETHODIMP SetOutputFormats(int iSampleFormats);
+	STDMETHODIMP SetDitherNoiseShaping(bool bNoiseShaping);
 	STDMETHODIMP_(REFERENCE_TIME) GetAudioTimeShift();
 	STDMETHODIMP SetAudioTimeShift(REFERENCE_TIME rtAudioTimeShift);
 	STDMETHODIMP SetAudioFilter1(const char* str_filter);
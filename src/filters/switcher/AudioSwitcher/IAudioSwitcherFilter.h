@@ -1,5 +1,5 @@
 /*
- * (C) 2017-2021 see Authors.txt
+ * (C) 2017-2023 see Authors.txt
  *
  * This file is part of MPC-BE.
  *
@@ -45,8 +45,9 @@ public IUnknown {
 	STDMETHOD(SetBassRedirect) (bool bBassRedirect) PURE;
 	STDMETHOD(SetLevels) (double dCenterLevel_dB, double dSurroundLevel_dB) PURE;
 	STDMETHOD(SetAudioGain) (double dGain_dB) PURE;
-	STDMETHOD(SetAutoVolumeControl) (bool bAutoVolumeControl, bool bNormBoost, int iNormLevel, int iNormRealeaseTime) PURE;
+	STDMETHOD(SetAutoVolumeControl) (bool bAutoVolumeControl, bool bNormBoost, int iNormLevel, int iNormRealeaseTime, int iNormLookahead) PURE;
 	STDMETHOD(SetOutputFormats) (int iSampleFormat) PURE;
+	STDMETHOD(SetDitherNoiseShaping) (bool bNoiseShaping) PURE;
 	STDMETHOD_(REFERENCE_TIME, GetAudioTimeShift) () PURE;
 	STDMETHOD(SetAudioTimeShift) (REFERENCE_TIME rtAudioTimeShift) PURE;
 	STDMETHOD(SetAudioFilter1)(const char* str_filter) PURE;
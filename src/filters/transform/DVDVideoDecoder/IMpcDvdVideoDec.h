@@ -26,6 +26,7 @@ enum ditype : int {
 	DIWeave,
 	DIBlend,
 	DIBob,
+	DIAdaptive,
 };
 
 interface __declspec(uuid("0ABEAA65-0317-47B9-AE1D-D9EA905AFD25"))
@@ -53,5 +54,9 @@ public IUnknown {
 	STDMETHOD(EnableInterlaced(bool fEnable)) PURE;
 	STDMETHOD_(bool, IsInterlacedEnabled()) PURE;
 
+	// 0 - auto
+	STDMETHOD(SetThreadNumber(int nValue)) PURE;
+	STDMETHOD_(int, GetThreadNumber()) PURE;
+
 	STDMETHOD(Apply()) PURE;
 };
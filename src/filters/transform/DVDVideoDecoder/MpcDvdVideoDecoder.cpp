@@ -29,6 +29,7 @@
 #include <emmintrin.h>
 
 #include "DSUtil/DSUtil.h"
+#include "DSUtil/CPUInfo.h"
 #include "DSUtil/GolombBuffer.h"
 #include "DSUtil/PixelUtils.h"
 #include <clsids.h>
@@ -46,6 +47,7 @@
 #define OPT_Saturation      L"ProcAmpSaturation"
 #define OPT_ForcedSubs      L"ForcedSubtitles"
 #define OPT_Interlaced      L"Interlaced"
+#define OPT_ThreadNumber    L"ThreadNumber"
 
 #define EPSILON 1e-4
 
@@ -319,7 +321,7 @@ CMpeg2DecFilter::CMpeg2DecFilter(LPUNKNOWN lpunk, HRESULT* phr)
 	if (ERROR_SUCCESS == key.Open(HKEY_CURRENT_USER, OPT_REGKEY_MPEGDec, KEY_READ)) {
 		DWORD dw;
 		if (ERROR_SUCCESS == key.QueryDWORDValue(OPT_DeintMethod, dw)) {
-			m_ditype = discard((ditype)dw, DIAuto, DIAuto, DIBob);
+			m_ditype = discard((ditype)dw, DIAuto, DIAuto, DIAdaptive);
 		}
 		if (ERROR_SUCCESS == key.QueryDWORDValue(OPT_Brightness, dw)) {
 			m_bright = discard((int)dw, 0, -128, 128);
@@ -339,16 +341,20 @@ CMpeg2DecFilter::CMpeg2DecFilter(LPUNKNOWN lpunk, HRESULT* phr)
 		if (ERROR_SUCCESS == key.QueryDWORDValue(OPT_Interlaced, dw)) {
 			m_fInterlaced = !!dw;
 		}
+		if (ERROR_SUCCESS == key.QueryDWORDValue(OPT_ThreadNumber, dw)) {
+			m_nThreadNumber = discard((int)dw, 0, 0, 16);
+		}
 	}
 #else
 	CProfile& profile = AfxGetProfile();
-	profile.ReadInt(OPT_SECTION_MPEGDec, OPT_DeintMethod, *(int*)&m_ditype, DIAuto, DIBob);
+	profile.ReadInt(OPT_SECTION_MPEGDec, OPT_DeintMethod, *(int*)&m_ditype, DIAuto, DIAdaptive);
 	profile.ReadInt(OPT_SECTION_MPEGDec, OPT_Brightness, m_bright, -128, 128);
 	profile.ReadInt(OPT_SECTION_MPEGDec, OPT_Contrast, m_cont, 0, 200);
 	profile.ReadInt(OPT_SECTION_MPEGDec, OPT_Hue, m_hue, -180, 180);
 	profile.ReadInt(OPT_SECTION_MPEGDec, OPT_Saturation, m_sat, 0, 200);
 	profile.ReadBool(OPT_SECTION_MPEGDec, OPT_ForcedSubs, m_fForcedSubs);
 	profile.ReadBool(OPT_SECTION_MPEGDec, OPT_Interlaced, m_fInterlaced);
+	profile.ReadInt(OPT_SECTION_MPEGDec, OPT_ThreadNumber, m_nThreadNumber, 0, 16);
 #endif
 
 	CalcBrCont(m_YTbl, m_bright, m_cont);
@@ -374,6 +380,7 @@ STDMETHODIMP CMpeg2DecFilter::Apply()
 		key.SetDWORDValue(OPT_Saturation, m_sat);
 		key.SetDWORDValue(OPT_ForcedSubs, m_fForcedSubs);
 		key.SetDWORDValue(OPT_Interlaced, m_fInterlaced);
+		key.SetDWORDValue(OPT_ThreadNumber, m_nThreadNumber);
 	}
 #else
 	CProfile& profile = AfxGetProfile();
@@ -384,6 +391,7 @@ STDMETHODIMP CMpeg2DecFilter::Apply()
 	profile.WriteInt(OPT_SECTION_MPEGDec, OPT_Saturation, m_sat);
 	profile.WriteBool(OPT_SECTION_MPEGDec, OPT_ForcedSubs, m_fForcedSubs);
 	profile.WriteBool(OPT_SECTION_MPEGDec, OPT_Interlaced, m_fInterlaced);
+	profile.WriteInt(OPT_SECTION_MPEGDec, OPT_ThreadNumber, m_nThreadNumber);
 #endif
 
 	return S_OK;
@@ -450,6 +458,7 @@ HRESULT CMpeg2DecFilter::NewSegment(REFERENCE_TIME tStart, REFERENCE_TIME tStop,
 	CAutoLock cAutoLock(&m_csReceive);
 	m_pClosedCaptionOutput->DeliverNewSegment(tStart, tStop, dRate);
 	m_fDropFrames = false;
+	m_fb.prev_valid = false;
 	return __super::NewSegment(tStart, tStop, dRate);
 }
 
@@ -501,6 +510,7 @@ void CMpeg2DecFilter::InputTypeChanged()
 
 	m_fFilm = false;
 	m_fb.flags = 0;
+	m_fb.prev_valid = false;
 }
 
 void CMpeg2DecFilter::SetDeinterlaceMethod()
@@ -732,6 +742,23 @@ HRESULT CMpeg2DecFilter::Deliver()
 		m_fb.rtStart = rtStart;
 		m_fb.rtStop = (rtStart + rtStop) / 2;
 	}
+	else if (m_fb.di == DIAdaptive) {
+		if (m_fb.prev_valid) {
+			AdaptivePlane(m_fb.buf[0], fbuf->buf[0], m_fb.prev[0], w, h, dpitch, spitch, dpitch, tff);
+			AdaptivePlane(m_fb.buf[1], fbuf->buf[1], m_fb.prev[1], w/2, h/2, dpitch/2, spitch/2, dpitch/2, tff);
+			AdaptivePlane(m_fb.buf[2], fbuf->buf[2], m_fb.prev[2], w/2, h/2, dpitch/2, spitch/2, dpitch/2, tff);
+		} else {
+			// nothing to compare with yet
+			BobPlane(m_fb.buf[0], fbuf->buf[0], w, h, dpitch, spitch, tff);
+			BobPlane(m_fb.buf[1], fbuf->buf[1], w/2, h/2, dpitch/2, spitch/2, tff);
+			BobPlane(m_fb.buf[2], fbuf->buf[2], w/2, h/2, dpitch/2, spitch/2, tff);
+		}
+
+		CopyPlane(h,   m_fb.prev[0], dpitch,   fbuf->buf[0], spitch);
+		CopyPlane(h/2, m_fb.prev[1], dpitch/2, fbuf->buf[1], spitch/2);
+		CopyPlane(h/2, m_fb.prev[2], dpitch/2, fbuf->buf[2], spitch/2);
+		m_fb.prev_valid = true;
+	}
 
 	// postproc
 	ApplyBrContHueSat(m_fb.buf[0], m_fb.buf[1], m_fb.buf[2], w, h, dpitch);
@@ -935,6 +962,11 @@ HRESULT CMpeg2DecFilter::StartStreaming()
 		return E_OUTOFMEMORY;
 	}
 
+	{
+		CAutoLock cAutoLock(&m_csProps);
+		m_dec->mpeg2_set_threads(m_nThreadNumber > 0 ? m_nThreadNumber : CPUInfo::GetProcessorNumber());
+	}
+
 	InputTypeChanged();
 
 	//	g_clock = clock();
@@ -1023,7 +1055,7 @@ STDMETHODIMP CMpeg2DecFilter::SetDeinterlaceMethod(ditype di)
 {
 	CAutoLock cAutoLock(&m_csProps);
 
-	if (di < DIAuto || di > DIBob) {
+	if (di < DIAuto || di > DIAdaptive) {
 		return E_INVALIDARG;
 	}
 
@@ -1185,6 +1217,19 @@ STDMETHODIMP_(bool) CMpeg2DecFilter::IsInterlacedEnabled()
 	return m_fInterlaced;
 }
 
+STDMETHODIMP CMpeg2DecFilter::SetThreadNumber(int nValue)
+{
+	CAutoLock cAutoLock(&m_csProps);
+	m_nThreadNumber = nValue;
+	return S_OK;
+}
+
+STDMETHODIMP_(int) CMpeg2DecFilter::GetThreadNumber()
+{
+	CAutoLock cAutoLock(&m_csProps);
+	return m_nThreadNumber;
+}
+
 //
 // CMpeg2DecInputPin
 //
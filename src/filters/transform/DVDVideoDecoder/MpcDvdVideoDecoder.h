@@ -52,6 +52,8 @@ class __declspec(uuid("39F81046-93AC-486D-882F-4ADD1CB068C6"))
 		int pitch = 0;
 		BYTE* buf_base = nullptr;;
 		BYTE* buf[6] = {};
+		BYTE* prev[3] = {}; // previous decoded frame for the motion-adaptive deinterlacer
+		bool prev_valid = false;
 		REFERENCE_TIME rtStart = 0;
 		REFERENCE_TIME rtStop = 0;
 		uint32_t flags = 0;
@@ -65,7 +67,7 @@ class __declspec(uuid("39F81046-93AC-486D-882F-4ADD1CB068C6"))
 			h = _h;
 			pitch = _pitch;
 			const unsigned size = pitch*h;
-			buf_base = (BYTE*)_aligned_malloc(size * 3 + 6 * 32, 32);
+			buf_base = (BYTE*)_aligned_malloc(size * 3 + size * 3 / 2 + 9 * 32, 32);
 			BYTE* p = buf_base;
 			buf[0] = p;
 			p += (size + 31) & ~31;
@@ -79,6 +81,13 @@ class __declspec(uuid("39F81046-93AC-486D-882F-4ADD1CB068C6"))
 			p += (size/4 + 31) & ~31;
 			buf[5] = p;
 			p += (size/4 + 31) & ~31;
+			prev[0] = p;
+			p += (size + 31) & ~31;
+			prev[1] = p;
+			p += (size/4 + 31) & ~31;
+			prev[2] = p;
+			p += (size/4 + 31) & ~31;
+			prev_valid = false;
 		}
 		void Free() {
 			if (buf_base) {
@@ -146,6 +155,7 @@ protected:
 	BYTE m_YTbl[256], m_UTbl[256*256], m_VTbl[256*256];
 	bool m_fForcedSubs       = true;
 	bool m_fInterlaced       = true;
+	int m_nThreadNumber      = 0;
 
 	void ApplyBrContHueSat(BYTE* srcy, BYTE* srcu, BYTE* srcv, int w, int h, int pitch);
 
@@ -174,6 +184,8 @@ public:
 	STDMETHODIMP_(bool) IsForcedSubtitlesEnabled();
 	STDMETHODIMP EnableInterlaced(bool fEnable);
 	STDMETHODIMP_(bool) IsInterlacedEnabled();
+	STDMETHODIMP SetThreadNumber(int nValue);
+	STDMETHODIMP_(int) GetThreadNumber();
 
 	STDMETHODIMP Apply();
 
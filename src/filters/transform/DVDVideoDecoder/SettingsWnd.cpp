@@ -64,6 +64,7 @@ bool CMpeg2DecSettingsWnd::OnConnect(const std::list<CComQIPtr<IUnknown, &IID_IU
 	m_procamp[3] = m_pM2DF->GetSaturation();
 	m_forcedsubs = m_pM2DF->IsForcedSubtitlesEnabled();
 	m_interlaced = m_pM2DF->IsInterlacedEnabled();
+	m_threads    = m_pM2DF->GetThreadNumber();
 
 	return true;
 }
@@ -94,11 +95,23 @@ bool CMpeg2DecSettingsWnd::OnActivate()
 	AddStringData(m_ditype_combo, L"Weave", DIWeave);
 	AddStringData(m_ditype_combo, L"Blend", DIBlend);
 	AddStringData(m_ditype_combo, L"Bob",   DIBob);
+	AddStringData(m_ditype_combo, L"Adaptive", DIAdaptive);
 	m_ditype_combo.SetCurSel(0);
 	SelectByItemData(m_ditype_combo, m_ditype);
 	m_ditype_combo.EnableWindow(!IsDlgButtonChecked(m_interlaced_check.GetDlgCtrlID()));
 	p.y += h25;
 
+	m_threads_static.Create(ResStr(IDS_VDF_THREADNUMBER), WS_VISIBLE | WS_CHILD, CRect(p, CSize(ScaleX(200), m_fontheight)), this);
+	m_threads_combo.Create(dwStyle | CBS_DROPDOWNLIST | WS_VSCROLL, CRect(p + CSize(ScaleX(210), -4), CSize(ScaleX(100), 200)), this, IDC_PP_COMBO2);
+	m_threads_combo.AddString(ResStr(IDS_VDF_AUTO));
+	for (int i = 1; i <= 16; i++) {
+		CString str;
+		str.Format(L"%d", i);
+		m_threads_combo.AddString(str);
+	}
+	m_threads_combo.SetCurSel(m_threads);
+	p.y += h25;
+
 	{
 		int h = std::max(21, m_fontheight); // special size for sliders
 		static const WCHAR* labels[] = {m_strBrightness, m_strContrast, m_strHue, m_strSaturation};
@@ -151,6 +164,7 @@ void CMpeg2DecSettingsWnd::OnDeactivate()
 	m_procamp[3] = (float)m_procamp_slider[3].GetPos();
 	m_interlaced = !!IsDlgButtonChecked(m_interlaced_check.GetDlgCtrlID());
 	m_forcedsubs = !!IsDlgButtonChecked(m_forcedsubs_check.GetDlgCtrlID());
+	m_threads    = m_threads_combo.GetCurSel();
 }
 
 bool CMpeg2DecSettingsWnd::OnApply()
@@ -165,6 +179,7 @@ bool CMpeg2DecSettingsWnd::OnApply()
 		m_pM2DF->SetSaturation(m_procamp[3]);
 		m_pM2DF->EnableForcedSubtitles(m_forcedsubs);
 		m_pM2DF->EnableInterlaced(m_interlaced);
+		m_pM2DF->SetThreadNumber(m_threads);
 		m_pM2DF->Apply();
 	}
 
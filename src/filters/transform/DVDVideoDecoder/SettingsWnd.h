@@ -34,9 +34,11 @@ class __declspec(uuid("E5FB6957-65E6-491B-BB37-B25C9FE3BEA7"))
 	int m_procamp[4];
 	bool m_interlaced;
 	bool m_forcedsubs;
+	int m_threads;
 
 	enum {
 		IDC_PP_COMBO1 = 10000,
+		IDC_PP_COMBO2,
 		IDC_PP_SLIDER1,
 		IDC_PP_SLIDER2,
 		IDC_PP_SLIDER3,
@@ -50,6 +52,8 @@ class __declspec(uuid("E5FB6957-65E6-491B-BB37-B25C9FE3BEA7"))
 
 	CStatic m_ditype_static;
 	CComboBox m_ditype_combo;
+	CStatic m_threads_static;
+	CComboBox m_threads_combo;
 	CStatic m_procamp_static[4];
 	CSliderCtrl m_procamp_slider[4];
 	CStatic m_procamp_value[4];
@@ -72,7 +76,7 @@ public:
 	bool OnApply();
 
 	static LPCWSTR GetWindowTitle() { return MAKEINTRESOURCEW(IDS_FILTER_SETTINGS_CAPTION); }
-	static CSize GetWindowSize() { return CSize(355, 296); }
+	static CSize GetWindowSize() { return CSize(355, 321); }
 
 	DECLARE_MESSAGE_MAP()
 
@@ -0,0 +1,109 @@
+/*
+ * (C) 2023 see Authors.txt
+ *
+ * This file is part of MPC-BE.
+ *
+ * MPC-BE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MPC-BE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "stdafx.h"
+#include <immintrin.h>
+#include "libmpeg2.h"
+#include "attributes.h"
+#include "simd.h"
+#include "idct_sse2.h"
+
+// AVX2 version of the AP-945 iDCT.
+// The row pass transforms two rows per register, each 128-bit lane with the
+// coefficient table of its own row. The column pass already covers all eight
+// columns of a block with one SSE2 register per row, it is shared with idct_sse2.cpp.
+// The output is bit-exact with mpeg2_idct_copy_sse2/mpeg2_idct_add_sse2.
+
+// tables for the row pairs 0-1, 2-3, 4-5, 6-7
+static __align32(int16_t, M256_tab_i[4][4][16]);
+
+static __forceinline __m256i DCT_8_INV_ROW_2(__m256i x, const int16_t (&tab)[4][16])
+{
+	const __m256i round = _mm256_set1_epi32(RND_INV_ROW);
+
+	x = _mm256_shufflelo_epi16(x, 0xD8);
+	x = _mm256_shufflehi_epi16(x, 0xD8);
+
+	__m256i a = _mm256_madd_epi16(_mm256_shuffle_epi32(x, 0x00), _mm256_load_si256((const __m256i*)tab[0]));
+	__m256i c = _mm256_madd_epi16(_mm256_shuffle_epi32(x, 0xAA), _mm256_load_si256((const __m256i*)tab[1]));
+	__m256i b = _mm256_madd_epi16(_mm256_shuffle_epi32(x, 0x55), _mm256_load_si256((const __m256i*)tab[2]));
+	__m256i d = _mm256_madd_epi16(_mm256_shuffle_epi32(x, 0xFF), _mm256_load_si256((const __m256i*)tab[3]));
+
+	a = _mm256_add_epi32(_mm256_add_epi32(a, round), c);
+	b = _mm256_add_epi32(b, d);
+
+	__m256i sum  = _mm256_srai_epi32(_mm256_add_epi32(a, b), 12);
+	__m256i diff = _mm256_srai_epi32(_mm256_sub_epi32(a, b), 12);
+
+	return _mm256_packs_epi32(sum, _mm256_shuffle_epi32(diff, 0x1B));
+}
+
+static __forceinline void idct_M256(int16_t* block)
+{
+	for (int i = 0; i < 4; i++) {
+		__m256i* rows = (__m256i*)(block + i * 16);
+		_mm256_storeu_si256(rows, DCT_8_INV_ROW_2(_mm256_loadu_si256(rows), M256_tab_i[i]));
+	}
+
+	// the column pass is legacy SSE code
+	_mm256_zeroupper();
+
+	__m128i &src0=*(__m128i*)(block+0*16/2);
+	__m128i &src1=*(__m128i*)(block+1*16/2);
+	__m128i &src2=*(__m128i*)(block+2*16/2);
+	__m128i &src3=*(__m128i*)(block+3*16/2);
+	__m128i &src4=*(__m128i*)(block+4*16/2);
+	__m128i &src5=*(__m128i*)(block+5*16/2);
+	__m128i &src6=*(__m128i*)(block+6*16/2);
+	__m128i &src7=*(__m128i*)(block+7*16/2);
+
+	__m128i xmm0,xmm1,xmm2,xmm3,xmm4,xmm5,xmm6,xmm7;
+	movdqa (xmm0, src5);
+	movdqa (xmm4, src7);
+	DCT_8_INV_COL_8(src0,src1,src2,src3,src4,src5,src6,src7,
+					xmm0,xmm1,xmm2,xmm3,xmm4,xmm5,xmm6,xmm7);
+}
+
+void mpeg2_idct_copy_avx2(int16_t* block, uint8_t* dest, const int stride)
+{
+	idct_M256(block);
+	idct_copy_out_sse2(block, dest, stride);
+}
+
+void mpeg2_idct_add_avx2(int, int16_t* block, uint8_t* dest, const int stride)
+{
+	idct_M256(block);
+	idct_add_out_sse2(block, dest, stride);
+}
+
+void mpeg2_idct_init_avx2()
+{
+	static const int16_t* const row_tab[8] = {
+		M128_tab_i_04, M128_tab_i_17, M128_tab_i_26, M128_tab_i_35,
+		M128_tab_i_04, M128_tab_i_35, M128_tab_i_26, M128_tab_i_17
+	};
+
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			memcpy(&M256_tab_i[i][j][0], row_tab[i * 2    ] + j * 8, 8 * sizeof(int16_t));
+			memcpy(&M256_tab_i[i][j][8], row_tab[i * 2 + 1] + j * 8, 8 * sizeof(int16_t));
+		}
+	}
+}
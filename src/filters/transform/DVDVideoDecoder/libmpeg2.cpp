@@ -26,6 +26,7 @@
 #include <string.h>
 #include <malloc.h>
 #include "libmpeg2.h"
+#include "DSUtil/CPUInfo.h"
 
 // decode
 
@@ -83,10 +84,20 @@ extern void mpeg2_idct_init_sse2();
 extern void mpeg2_idct_copy_sse2(int16_t* block, uint8_t* dest, const int stride);
 extern void mpeg2_idct_add_sse2(const int last, int16_t* block, uint8_t* dest, const int stride);
 
+// idct (avx2)
+
+extern void mpeg2_idct_init_avx2();
+extern void mpeg2_idct_copy_avx2(int16_t* block, uint8_t* dest, const int stride);
+extern void mpeg2_idct_add_avx2(const int last, int16_t* block, uint8_t* dest, const int stride);
+
 // mc (sse2)
 
 extern mpeg2_mc_t mpeg2_mc_sse2;
 
+// mc (avx2)
+
+extern mpeg2_mc_t mpeg2_mc_avx2;
+
 //
 
 CMpeg2Dec::CMpeg2Dec()
@@ -123,6 +134,12 @@ CMpeg2Dec::CMpeg2Dec()
     memset(&m_intra_quantizer_matrix, 0, sizeof(m_intra_quantizer_matrix));
     memset(&m_non_intra_quantizer_matrix, 0, sizeof(m_non_intra_quantizer_matrix));
 
+	m_nb_slice_jobs = 0;
+	m_slice_next = 0;
+	m_slice_generation = 0;
+	m_slice_active = 0;
+	m_slice_exit = false;
+
 	//
 
 	mpeg2_init();
@@ -130,6 +147,7 @@ CMpeg2Dec::CMpeg2Dec()
 
 CMpeg2Dec::~CMpeg2Dec()
 {
+	slice_stop_threads();
 	mpeg2_close();
 }
 
@@ -147,6 +165,8 @@ void CMpeg2Dec::mpeg2_close()
 	/* static uint8_t finalizer[] = {0,0,1,0xb4}; */
 	/* mpeg2_decode_data (mpeg2dec, finalizer, finalizer+4); */
 
+	m_nb_slice_jobs = 0;
+
 	mpeg2_header_state_init();
 	_aligned_free(m_chunk_buffer);
 }
@@ -347,11 +367,17 @@ mpeg2_state_t CMpeg2Dec::mpeg2_parse()
 
 			m_bytes_since_pts += copied;
 
-			m_decoder.mpeg2_slice(m_code, m_chunk_start);
+			if(m_slice_decoders.size())
+				slice_queue(m_code, m_chunk_start, m_chunk_ptr);
+			else
+				m_decoder.mpeg2_slice(m_code, m_chunk_start);
 			m_code = m_buf_start[-1];
 			m_chunk_ptr = m_chunk_start;
 		}
 
+		/* all slices of the picture are queued, finish them before any header touches m_decoder */
+		slice_flush();
+
 		if((unsigned)(m_code - 1) >= 0xb0 - 1)
 			break;
 		if(seek_chunk() == STATE_BUFFER)
@@ -399,6 +425,112 @@ void CMpeg2Dec::mpeg2_slice_region(int start, int end)
 	m_nb_decode_slices = end - start;
 }
 
+void CMpeg2Dec::mpeg2_set_threads(int threads)
+{
+	slice_stop_threads();
+	m_slice_decoders.clear();
+	m_nb_slice_jobs = 0;
+
+	threads = std::clamp(threads, 1, 16);
+	if(threads == 1)
+		return;
+
+	for(int i = 0; i < threads; i++)
+		m_slice_decoders.emplace_back(std::make_unique<CMpeg2Decoder>());
+
+	m_slice_exit = false;
+	for(size_t i = 1; i < m_slice_decoders.size(); i++)
+		m_slice_threads.emplace_back(&CMpeg2Dec::slice_thread_proc, this, i);
+}
+
+void CMpeg2Dec::slice_stop_threads()
+{
+	if(m_slice_threads.empty())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_slice_mutex);
+		m_slice_exit = true;
+	}
+	m_slice_start_cv.notify_all();
+
+	for(auto& thread : m_slice_threads)
+		thread.join();
+	m_slice_threads.clear();
+}
+
+void CMpeg2Dec::slice_queue(uint8_t code, const uint8_t* start, const uint8_t* end)
+{
+	if(m_nb_slice_jobs == m_slice_jobs.size())
+		m_slice_jobs.emplace_back();
+
+	/* the chunk buffer gets reused for the next slice, keep a copy. */
+	/* the bitstream reader may look a few bytes past the end, pad it like the chunk buffer */
+	slice_job_t& job = m_slice_jobs[m_nb_slice_jobs++];
+	job.code = code;
+	job.data.assign(start, end);
+	job.data.resize(job.data.size() + 8, 0);
+}
+
+void CMpeg2Dec::slice_decode_jobs(CMpeg2Decoder& decoder)
+{
+	for(size_t i = m_slice_next++; i < m_nb_slice_jobs; i = m_slice_next++)
+		decoder.mpeg2_slice(m_slice_jobs[i].code, m_slice_jobs[i].data.data());
+}
+
+void CMpeg2Dec::slice_flush()
+{
+	if(!m_nb_slice_jobs)
+		return;
+
+	/* slices of a picture write disjoint macroblocks and only read the reference frames, */
+	/* so they can be decoded in any order as long as the picture is complete before we return */
+	for(auto& decoder : m_slice_decoders)
+		decoder->mpeg2_copy_picture_state(m_decoder);
+
+	m_slice_next = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_slice_mutex);
+		m_slice_active = m_slice_threads.size();
+		m_slice_generation++;
+	}
+	m_slice_start_cv.notify_all();
+
+	slice_decode_jobs(*m_slice_decoders[0]);
+
+	{
+		std::unique_lock<std::mutex> lock(m_slice_mutex);
+		m_slice_done_cv.wait(lock, [this] { return m_slice_active == 0; });
+	}
+
+	m_nb_slice_jobs = 0;
+}
+
+void CMpeg2Dec::slice_thread_proc(size_t index)
+{
+	CMpeg2Decoder& decoder = *m_slice_decoders[index];
+	unsigned generation = 0;
+
+	for(;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_slice_mutex);
+			m_slice_start_cv.wait(lock, [&] { return m_slice_exit || m_slice_generation != generation; });
+			if(m_slice_exit)
+				return;
+			generation = m_slice_generation;
+		}
+
+		slice_decode_jobs(decoder);
+
+		{
+			std::lock_guard<std::mutex> lock(m_slice_mutex);
+			if(--m_slice_active == 0)
+				m_slice_done_cv.notify_one();
+		}
+	}
+}
+
 void CMpeg2Dec::mpeg2_pts(uint32_t pts)
 {
 	m_pts_previous = m_pts_current;
@@ -1657,10 +1789,20 @@ CMpeg2Decoder::CMpeg2Decoder()
 
 	m_mpeg1 = 0;
 
-	m_idct_init = mpeg2_idct_init_sse2;
-	m_idct_copy = mpeg2_idct_copy_sse2;
-	m_idct_add = mpeg2_idct_add_sse2;
-	m_mc = &mpeg2_mc_sse2;
+	if(CPUInfo::HaveAVX2())
+	{
+		m_idct_init = mpeg2_idct_init_avx2;
+		m_idct_copy = mpeg2_idct_copy_avx2;
+		m_idct_add = mpeg2_idct_add_avx2;
+		m_mc = &mpeg2_mc_avx2;
+	}
+	else
+	{
+		m_idct_init = mpeg2_idct_init_sse2;
+		m_idct_copy = mpeg2_idct_copy_sse2;
+		m_idct_add = mpeg2_idct_add_sse2;
+		m_mc = &mpeg2_mc_sse2;
+	}
 
 	if(!m_idct_initialized)
 	{
@@ -1674,6 +1816,22 @@ CMpeg2Decoder::~CMpeg2Decoder()
 	if(m_DCTblock) _aligned_free(m_DCTblock);
 }
 
+void CMpeg2Decoder::mpeg2_copy_picture_state(const CMpeg2Decoder& src)
+{
+	int16_t* DCTblock = m_DCTblock;
+	*this = src;
+	m_DCTblock = DCTblock;
+
+	/* ref2 points into the motion_t of src, rebase it */
+	for(int i = 0; i < 2; i++)
+	{
+		if(src.m_f_motion.ref2[i])
+			m_f_motion.ref2[i] = m_f_motion.ref[0] + (src.m_f_motion.ref2[i] - src.m_f_motion.ref[0]);
+		if(src.m_b_motion.ref2[i])
+			m_b_motion.ref2[i] = m_b_motion.ref[0] + (src.m_b_motion.ref2[i] - src.m_b_motion.ref[0]);
+	}
+}
+
 #define bit_buf (m_bitstream_buf)
 #define bits (m_bitstream_bits)
 #define bit_ptr (m_bitstream_ptr)
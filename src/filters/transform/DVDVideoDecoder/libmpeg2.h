@@ -24,6 +24,12 @@
 #pragma once
 
 #include <stdint.h>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 #define MPEG2_VERSION(a,b,c) (((a)<<16)|((b)<<8)|(c))
 #define MPEG2_RELEASE MPEG2_VERSION (0, 3, 2)	/* 0.3.2 */
@@ -216,6 +222,9 @@ public:
 	void mpeg2_init_fbuf(uint8_t* current_fbuf[3], uint8_t* forward_fbuf[3], uint8_t* backward_fbuf[3]);
 	void mpeg2_slice(int code, const uint8_t* buffer);
 
+	// copies the picture level state of another decoder, used by the slice threads
+	void mpeg2_copy_picture_state(const CMpeg2Decoder& src);
+
 	int16_t* m_DCTblock;
 
     /* bit parsing stuff */
@@ -313,6 +322,31 @@ class CMpeg2Dec
 	int picture_display_ext();
 	int picture_coding_ext();
 
+	/* slice threading */
+	struct slice_job_t {
+		uint8_t code;
+		std::vector<uint8_t> data;
+	};
+
+	std::vector<std::unique_ptr<CMpeg2Decoder>> m_slice_decoders; /* 0: caller thread, 1..n: workers */
+	std::vector<std::thread> m_slice_threads;
+	std::vector<slice_job_t> m_slice_jobs;
+	size_t m_nb_slice_jobs;
+	std::atomic<size_t> m_slice_next;
+
+	std::mutex m_slice_mutex;
+	std::condition_variable m_slice_start_cv;
+	std::condition_variable m_slice_done_cv;
+	unsigned m_slice_generation;
+	size_t m_slice_active;
+	bool m_slice_exit;
+
+	void slice_queue(uint8_t code, const uint8_t* start, const uint8_t* end);
+	void slice_flush();
+	void slice_decode_jobs(CMpeg2Decoder& decoder);
+	void slice_thread_proc(size_t index);
+	void slice_stop_threads();
+
 public:
 	CMpeg2Dec();
 	virtual ~CMpeg2Dec();
@@ -326,6 +360,7 @@ public:
 
 	void mpeg2_skip(int skip);
 	void mpeg2_slice_region(int start, int end);
+	void mpeg2_set_threads(int threads);
 
 	void mpeg2_pts(uint32_t pts);
 
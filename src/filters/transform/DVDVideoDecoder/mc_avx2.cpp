@@ -0,0 +1,141 @@
+/*
+ * (C) 2023 see Authors.txt
+ *
+ * This file is part of MPC-BE.
+ *
+ * MPC-BE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MPC-BE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "stdafx.h"
+#include <immintrin.h>
+#include "libmpeg2.h"
+
+// AVX2 motion compensation for 8 pixel wide (chroma) blocks, four rows per register.
+// A 16 pixel row already fills an SSE2 register and splitting rows across ymm lanes
+// costs more than it saves, so 16 pixel wide blocks keep using the SSE2 functions.
+// The half-pel rounding follows mc_sse2.cpp exactly, including the
+// approximations of the xy cases, so both tables produce the same pictures.
+
+void MC_put_o_16_sse2(uint8_t* dest, const uint8_t* ref, const int stride, int height);
+void MC_put_x_16_sse2(uint8_t* dest, const uint8_t* ref, const int stride, int height);
+void MC_put_y_16_sse2(uint8_t* dest, const uint8_t* ref, const int stride, int height);
+void MC_put_xy_16_sse2(uint8_t* dest, const uint8_t* ref, const int stride, int height);
+void MC_avg_o_16_sse2(uint8_t* dest, const uint8_t* ref, const int stride, int height);
+void MC_avg_x_16_sse2(uint8_t* dest, const uint8_t* ref, const int stride, int height);
+void MC_avg_y_16_sse2(uint8_t* dest, const uint8_t* ref, const int stride, int height);
+void MC_avg_xy_16_sse2(uint8_t* dest, const uint8_t* ref, const int stride, int height);
+
+static __forceinline __m256i load_8x4(const uint8_t* src, const int stride)
+{
+	const __m128i lo = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)src), _mm_loadl_epi64((const __m128i*)(src + stride)));
+	const __m128i hi = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)(src + stride * 2)), _mm_loadl_epi64((const __m128i*)(src + stride * 3)));
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+static __forceinline void store_8x4(uint8_t* dest, const int stride, const __m256i v)
+{
+	const __m128i lo = _mm256_castsi256_si128(v);
+	const __m128i hi = _mm256_extracti128_si256(v, 1);
+	_mm_storel_epi64((__m128i*)dest, lo);
+	_mm_storeh_pd((double*)(dest + stride), _mm_castsi128_pd(lo));
+	_mm_storel_epi64((__m128i*)(dest + stride * 2), hi);
+	_mm_storeh_pd((double*)(dest + stride * 3), _mm_castsi128_pd(hi));
+}
+
+template <bool avg>
+static __forceinline void MC_o_8_avx2(uint8_t* dest, const uint8_t* ref, const int stride, int height)
+{
+	for (; height; height -= 4, ref += stride * 4, dest += stride * 4) {
+		__m256i r = load_8x4(ref, stride);
+		if (avg) {
+			r = _mm256_avg_epu8(r, load_8x4(dest, stride));
+		}
+		store_8x4(dest, stride, r);
+	}
+	_mm256_zeroupper();
+}
+
+template <bool avg>
+static __forceinline void MC_x_8_avx2(uint8_t* dest, const uint8_t* ref, const int stride, int height)
+{
+	for (; height; height -= 4, ref += stride * 4, dest += stride * 4) {
+		__m256i r = _mm256_avg_epu8(load_8x4(ref, stride), load_8x4(ref + 1, stride));
+		if (avg) {
+			r = _mm256_avg_epu8(r, load_8x4(dest, stride));
+		}
+		store_8x4(dest, stride, r);
+	}
+	_mm256_zeroupper();
+}
+
+template <bool avg>
+static __forceinline void MC_y_8_avx2(uint8_t* dest, const uint8_t* ref, const int stride, int height)
+{
+	for (; height; height -= 4, ref += stride * 4, dest += stride * 4) {
+		__m256i r = _mm256_avg_epu8(load_8x4(ref, stride), load_8x4(ref + stride, stride));
+		if (avg) {
+			r = _mm256_avg_epu8(r, load_8x4(dest, stride));
+		}
+		store_8x4(dest, stride, r);
+	}
+	_mm256_zeroupper();
+}
+
+static void MC_put_xy_8_avx2(uint8_t* dest, const uint8_t* ref, const int stride, int height)
+{
+	// every odd row of horizontal averages is lowered by one before the vertical average
+	const __m256i odd  = _mm256_set_epi64x(0x0101010101010101, 0, 0x0101010101010101, 0);
+	const __m256i even = _mm256_set_epi64x(0, 0x0101010101010101, 0, 0x0101010101010101);
+
+	for (; height; height -= 4, ref += stride * 4, dest += stride * 4) {
+		__m256i h0 = _mm256_avg_epu8(load_8x4(ref, stride), load_8x4(ref + 1, stride));
+		__m256i h1 = _mm256_avg_epu8(load_8x4(ref + stride, stride), load_8x4(ref + stride + 1, stride));
+		store_8x4(dest, stride, _mm256_avg_epu8(_mm256_subs_epu8(h0, odd), _mm256_subs_epu8(h1, even)));
+	}
+	_mm256_zeroupper();
+}
+
+static void MC_avg_xy_8_avx2(uint8_t* dest, const uint8_t* ref, const int stride, int height)
+{
+	// unlike the other xy cases the SSE2 code averages vertically first
+	const __m256i one = _mm256_set1_epi8(1);
+
+	for (; height; height -= 4, ref += stride * 4, dest += stride * 4) {
+		__m256i v0 = _mm256_avg_epu8(load_8x4(ref, stride), load_8x4(ref + stride, stride));
+		__m256i v1 = _mm256_avg_epu8(load_8x4(ref + 1, stride), load_8x4(ref + stride + 1, stride));
+		__m256i r = _mm256_avg_epu8(_mm256_subs_epu8(v0, one), v1);
+		store_8x4(dest, stride, _mm256_avg_epu8(r, load_8x4(dest, stride)));
+	}
+	_mm256_zeroupper();
+}
+
+static void MC_put_o_8_avx2(uint8_t* dest, const uint8_t* ref, const int stride, int height) { MC_o_8_avx2<false>(dest, ref, stride, height); }
+static void MC_put_x_8_avx2(uint8_t* dest, const uint8_t* ref, const int stride, int height) { MC_x_8_avx2<false>(dest, ref, stride, height); }
+static void MC_put_y_8_avx2(uint8_t* dest, const uint8_t* ref, const int stride, int height) { MC_y_8_avx2<false>(dest, ref, stride, height); }
+
+static void MC_avg_o_8_avx2(uint8_t* dest, const uint8_t* ref, const int stride, int height) { MC_o_8_avx2<true>(dest, ref, stride, height); }
+static void MC_avg_x_8_avx2(uint8_t* dest, const uint8_t* ref, const int stride, int height) { MC_x_8_avx2<true>(dest, ref, stride, height); }
+static void MC_avg_y_8_avx2(uint8_t* dest, const uint8_t* ref, const int stride, int height) { MC_y_8_avx2<true>(dest, ref, stride, height); }
+
+mpeg2_mc_t mpeg2_mc_avx2 = {
+	{
+		MC_put_o_16_sse2, MC_put_x_16_sse2, MC_put_y_16_sse2, MC_put_xy_16_sse2,
+		MC_put_o_8_avx2,  MC_put_x_8_avx2,  MC_put_y_8_avx2,  MC_put_xy_8_avx2
+	},
+	{
+		MC_avg_o_16_sse2, MC_avg_x_16_sse2, MC_avg_y_16_sse2, MC_avg_xy_16_sse2,
+		MC_avg_o_8_avx2,  MC_avg_x_8_avx2,  MC_avg_y_8_avx2,  MC_avg_xy_8_avx2
+	}
+};
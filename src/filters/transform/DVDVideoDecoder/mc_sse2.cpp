@@ -26,9 +26,9 @@
 #include "attributes.h"
 #include "simd.h"
 
-static const __m128i const_1_16_bytes=_mm_set1_epi16(1);
+static const __m128i const_1_16_bytes=_mm_set1_epi8(1);
 
-static void MC_put_o_16_sse2(uint8_t* ecx, const uint8_t* edx, const int eax, int esi)
+void MC_put_o_16_sse2(uint8_t* ecx, const uint8_t* edx, const int eax, int esi)
 {
 	const int edi= eax+eax;
 	const int ebx= edi+eax;
@@ -62,7 +62,7 @@ static void MC_put_o_8_sse2(uint8_t* ecx, const uint8_t* edx, const int eax, int
 	}
 }
 
-static void MC_put_x_16_sse2(uint8_t* ecx, const uint8_t* edx, const int eax, int esi)
+void MC_put_x_16_sse2(uint8_t* ecx, const uint8_t* edx, const int eax, int esi)
 {
 	const int edi= eax+eax;
 	const int ebx= edi+eax;
@@ -110,7 +110,7 @@ static void MC_put_x_8_sse2(uint8_t* ecx, const uint8_t* edx, const int eax, int
 	}
 }
 
-static void MC_put_y_16_sse2(uint8_t* ecx, const uint8_t* edx, const int eax, int esi)
+void MC_put_y_16_sse2(uint8_t* ecx, const uint8_t* edx, const int eax, int esi)
 {
 	const int edi= eax+eax;
 	const int ebx= edi+eax;
@@ -159,7 +159,7 @@ static void MC_put_y_8_sse2(uint8_t* ecx, const uint8_t* edx, const int eax, int
 	}
 }
 
-static void MC_put_xy_16_sse2(uint8_t* dest, const uint8_t* ref, const int stride, int height)
+void MC_put_xy_16_sse2(uint8_t* dest, const uint8_t* ref, const int stride, int height)
 {
 	const uint8_t *edx= ref ;
 	uint8_t  *ecx= dest;
@@ -217,7 +217,7 @@ static void MC_put_xy_8_sse2(uint8_t* dest, const uint8_t* ref, const int stride
 	}
 }
 
-static void MC_avg_o_16_sse2(uint8_t* dest, const uint8_t* ref, const int stride, int height)
+void MC_avg_o_16_sse2(uint8_t* dest, const uint8_t* ref, const int stride, int height)
 {
 	const uint8_t *edx= ref;
 	uint8_t *ecx= dest;
@@ -271,7 +271,7 @@ static void MC_avg_o_8_sse2(uint8_t* dest, const uint8_t* ref, const int stride,
 	}
 }
 
-static void MC_avg_x_16_sse2(uint8_t* dest, const uint8_t* ref, const int stride, int height)
+void MC_avg_x_16_sse2(uint8_t* dest, const uint8_t* ref, const int stride, int height)
 {
 	const uint8_t *edx= ref;
 	uint8_t *ecx= dest;
@@ -339,7 +339,7 @@ static void MC_avg_x_8_sse2(uint8_t* dest, const uint8_t* ref, const int stride,
 	}
 }
 
-static void MC_avg_y_16_sse2(uint8_t* dest, const uint8_t* ref, const int stride, int height)
+void MC_avg_y_16_sse2(uint8_t* dest, const uint8_t* ref, const int stride, int height)
 {
 	const uint8_t *edx= ref;
 	uint8_t *ecx= dest;
@@ -380,9 +380,9 @@ static void MC_avg_y_8_sse2(uint8_t* dest, const uint8_t* ref, const int stride,
 	int edi= eax+eax;
 	int ebx= edi+eax;
 	__m128i xmm0,xmm1,xmm2,xmm3,xmm4,xmm5;
-	movhpd (xmm0, edx );
-	movlpd (xmm0, edx+eax );
 	for (; esi; edx+=edi*2,ecx+=edi*2,esi-=4) {
+		movhpd (xmm0, edx );
+		movlpd (xmm0, edx+eax );
 		movlhps (xmm1, xmm0);
 		movlpd (xmm1, edx+edi );
 		movlhps (xmm2, xmm1);
@@ -401,11 +401,10 @@ static void MC_avg_y_8_sse2(uint8_t* dest, const uint8_t* ref, const int stride,
 		movlpd (ecx+eax, xmm0 );
 		movhpd (ecx+edi, xmm2 );
 		movlpd (ecx+ebx, xmm2);
-		movdqa (xmm0, xmm3 );
 	}
 }
 
-static void MC_avg_xy_16_sse2(uint8_t* dest, const uint8_t* ref, const int stride, int height)
+void MC_avg_xy_16_sse2(uint8_t* dest, const uint8_t* ref, const int stride, int height)
 {
 	const uint8_t *edx= ref;
 	uint8_t *ecx= dest;
@@ -445,12 +444,11 @@ static void MC_avg_xy_8_sse2(uint8_t* dest, const uint8_t* ref, const int stride
 	int edi= eax+eax;
 	__m128i xmm7,xmm0,xmm2,xmm1,xmm3,xmm4;
 	movdqa (xmm7, const_1_16_bytes );
-	movhpd (xmm0, edx );
-	movlpd (xmm0, edx+eax );
-	movhpd (xmm2, edx+1 );
-	movlpd (xmm2, edx+eax+1 );
 	for (; esi; edx+=edi,ecx+=edi,esi-=2) {
-
+		movhpd (xmm0, edx );
+		movlpd (xmm0, edx+eax );
+		movhpd (xmm2, edx+1 );
+		movlpd (xmm2, edx+eax+1 );
 		movhpd (xmm1, edx+eax );
 		movlpd (xmm1, edx+edi );
 		movhpd (xmm3, edx+eax+1 );
@@ -464,8 +462,6 @@ static void MC_avg_xy_8_sse2(uint8_t* dest, const uint8_t* ref, const int stride
 		pavgb (xmm0, xmm4 );
 		movhpd (ecx, xmm0 );
 		movlpd (ecx+eax, xmm0 );
-		movdqa (xmm0, xmm1 );
-		movdqa (xmm2, xmm3 );
 	}
 }
 
@@ -3,6 +3,8 @@
 // Used by MpcDvdVideoDecoder.rc
 //
 #define IDS_FILTER_SETTINGS_CAPTION     7000
+#define IDS_VDF_AUTO                    7401
+#define IDS_VDF_THREADNUMBER            7402
 #define IDS_MPEG2_INTERLACE_FLAG        7501
 #define IDS_MPEG2_FORCED_SUBS           7502
 #define IDS_MPEG2_DEINTERLACING         7503
@@ -24,5 +24,6 @@
 
 #define __align8(t,v) __declspec(align(8)) t v
 #define __align16(t,v) __declspec(align(16)) t v
+#define __align32(t,v) __declspec(align(32)) t v
 
 #endif
@@ -754,6 +754,7 @@ HRESULT CD3D11Decoder::DeliverFrame()
 	m_pFilter->AddFrameSideData(pSample, pFrame);
 
 	HRESULT hr = m_pFilter->GetOutputPin()->Deliver(pSample);
+	m_pFilter->FrameDelivered();
 
 	if (bSizeChanged && biHeight) {
 		m_pFilter->NotifyEvent(EC_VIDEO_SIZE_CHANGED, MAKELPARAM(biWidth, abs(biHeight)), 0);
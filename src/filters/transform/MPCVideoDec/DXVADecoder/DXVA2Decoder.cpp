@@ -116,6 +116,7 @@ HRESULT CDXVA2Decoder::DeliverFrame()
 	m_pFilter->AddFrameSideData(pSample, pFrame);
 
 	HRESULT hr = m_pFilter->GetOutputPin()->Deliver(pSample);
+	m_pFilter->FrameDelivered();
 
 	if (bSizeChanged && biHeight) {
 		m_pFilter->NotifyEvent(EC_VIDEO_SIZE_CHANGED, MAKELPARAM(biWidth, abs(biHeight)), 0);
@@ -0,0 +1,169 @@
+/*
+ * (C) 2023 see Authors.txt
+ *
+ * This file is part of MPC-BE.
+ *
+ * MPC-BE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MPC-BE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "stdafx.h"
+#include "DecodedFrameRing.h"
+#include "DSUtil/DSUtil.h"
+#include <IMediaSideData.h>
+
+// the side data set by CMPCVideoDecFilter::AddFrameSideData()
+static const GUID* s_sidedata[] = {
+	&IID_MediaSideDataHDR,
+	&IID_MediaSideDataHDRContentLightLevel,
+};
+
+static long GetImageSize(IMediaSample* pSample, const CMediaType& mt)
+{
+	BITMAPINFOHEADER bih;
+	if (!ExtractBIH(&mt, &bih)) {
+		return 0;
+	}
+
+	const long size = bih.biSizeImage ? bih.biSizeImage : DIBSIZE(bih);
+	return std::min(size, pSample->GetSize());
+}
+
+static bool IsSameFormat(const CDecodedFrameRing::frame_t& frame, const CMediaType& mt)
+{
+	return frame.subtype == mt.subtype
+		&& frame.format.size() == mt.cbFormat
+		&& !memcmp(frame.format.data(), mt.pbFormat, mt.cbFormat);
+}
+
+void CDecodedFrameRing::SetMaxSize(const size_t size)
+{
+	m_maxSize = size;
+
+	while (m_size > m_maxSize) {
+		m_size -= m_frames.front().data.size();
+		m_frames.pop_front();
+	}
+}
+
+void CDecodedFrameRing::Clear()
+{
+	m_frames.clear();
+	m_size = 0;
+}
+
+void CDecodedFrameRing::Add(IMediaSample* pSample, const CMediaType& mt, const REFERENCE_TIME rtStart, const REFERENCE_TIME rtStop)
+{
+	BYTE* pData = nullptr;
+	const long size = GetImageSize(pSample, mt);
+	if (size <= 0 || (size_t)size > m_maxSize || FAILED(pSample->GetPointer(&pData))) {
+		return;
+	}
+
+	if (!m_frames.empty() && !IsSameFormat(m_frames.back(), mt)) {
+		// the old frames can't be delivered anymore
+		Clear();
+	}
+
+	// the same frame is decoded again when a GOP is decoded once more
+	auto it = std::find_if(m_frames.begin(), m_frames.end(), [&](const frame_t& frame) {
+		return frame.rtStart == rtStart;
+	});
+	if (it != m_frames.end()) {
+		m_size -= it->data.size();
+		m_frames.erase(it);
+	}
+
+	while (!m_frames.empty() && m_size + size > m_maxSize) {
+		m_size -= m_frames.front().data.size();
+		m_frames.pop_front();
+	}
+
+	frame_t frame;
+	frame.rtStart = rtStart;
+	frame.rtStop  = rtStop;
+	frame.subtype = mt.subtype;
+	frame.format.assign(mt.pbFormat, mt.pbFormat + mt.cbFormat);
+	frame.data.assign(pData, pData + size);
+
+	if (CComQIPtr<IMediaSample2> pMS2 = pSample) {
+		AM_SAMPLE2_PROPERTIES props;
+		if (SUCCEEDED(pMS2->GetProperties(sizeof(props), (BYTE*)&props))) {
+			frame.dwTypeSpecificFlags = props.dwTypeSpecificFlags;
+		}
+	}
+
+	if (CComQIPtr<IMediaSideData> pMediaSideData = pSample) {
+		for (const auto& guid : s_sidedata) {
+			const BYTE* pSideData = nullptr;
+			size_t sidesize = 0;
+			if (SUCCEEDED(pMediaSideData->GetSideData(*guid, &pSideData, &sidesize)) && pSideData && sidesize) {
+				frame.sidedata.emplace_back(*guid, std::vector<BYTE>(pSideData, pSideData + sidesize));
+			}
+		}
+	}
+
+	m_size += frame.data.size();
+	m_frames.emplace_back(std::move(frame));
+}
+
+const CDecodedFrameRing::frame_t* CDecodedFrameRing::Find(const REFERENCE_TIME rtTarget, const REFERENCE_TIME rtDuration)
+{
+	const frame_t* pFound = nullptr;
+	for (const auto& frame : m_frames) {
+		if (frame.rtStart >= rtTarget && frame.rtStart - rtTarget < rtDuration
+				&& (!pFound || frame.rtStart < pFound->rtStart)) {
+			pFound = &frame;
+		}
+	}
+
+	if (!pFound) {
+		m_nMisses++;
+	}
+
+	return pFound;
+}
+
+bool CDecodedFrameRing::Copy(const frame_t& frame, IMediaSample* pSample, const CMediaType& mt)
+{
+	BYTE* pData = nullptr;
+	if (!IsSameFormat(frame, mt) || pSample->GetSize() < (long)frame.data.size() || FAILED(pSample->GetPointer(&pData))) {
+		m_nMisses++;
+		return false;
+	}
+
+	memcpy(pData, frame.data.data(), frame.data.size());
+	pSample->SetActualDataLength((long)frame.data.size());
+
+	// the same flags and side data as when the frame was decoded
+	if (CComQIPtr<IMediaSample2> pMS2 = pSample) {
+		AM_SAMPLE2_PROPERTIES props;
+		if (SUCCEEDED(pMS2->GetProperties(sizeof(props), (BYTE*)&props))) {
+			props.dwTypeSpecificFlags = frame.dwTypeSpecificFlags;
+			pMS2->SetProperties(sizeof(props), (BYTE*)&props);
+		}
+	}
+
+	if (frame.sidedata.size()) {
+		if (CComQIPtr<IMediaSideData> pMediaSideData = pSample) {
+			for (const auto& [guid, sidedata] : frame.sidedata) {
+				pMediaSideData->SetSideData(guid, sidedata.data(), sidedata.size());
+			}
+		}
+	}
+
+	m_nHits++;
+
+	return true;
+}
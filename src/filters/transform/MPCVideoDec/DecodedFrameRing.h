@@ -0,0 +1,65 @@
+/*
+ * (C) 2023 see Authors.txt
+ *
+ * This file is part of MPC-BE.
+ *
+ * MPC-BE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MPC-BE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <deque>
+
+// Copies of the last converted output frames, including the preroll frames.
+// A frame step back seeks to the previous frame, which is usually in the ring,
+// so the decoder can deliver it right after the new segment.
+
+class CDecodedFrameRing
+{
+public:
+	struct frame_t {
+		REFERENCE_TIME rtStart; // stream time (segment start + sample time)
+		REFERENCE_TIME rtStop;
+		GUID subtype;
+		std::vector<BYTE> format;
+		std::vector<BYTE> data;
+		DWORD dwTypeSpecificFlags = 0;
+		std::vector<std::pair<GUID, std::vector<BYTE>>> sidedata;
+	};
+
+private:
+	std::deque<frame_t> m_frames; // in the order of adding
+	size_t m_maxSize = 0;
+	size_t m_size    = 0;
+
+	UINT64 m_nHits   = 0;
+	UINT64 m_nMisses = 0;
+
+public:
+	void SetMaxSize(const size_t size);
+	size_t GetMaxSize() const { return m_maxSize; }
+	size_t GetSize() const { return m_size; }
+	bool IsEnabled() const { return m_maxSize > 0; }
+
+	void Clear();
+	void Add(IMediaSample* pSample, const CMediaType& mt, const REFERENCE_TIME rtStart, const REFERENCE_TIME rtStop);
+
+	// the first frame that starts at rtTarget or less than rtDuration after it
+	const frame_t* Find(const REFERENCE_TIME rtTarget, const REFERENCE_TIME rtDuration);
+	bool Copy(const frame_t& frame, IMediaSample* pSample, const CMediaType& mt);
+
+	UINT64 GetHits() const { return m_nHits; }
+	UINT64 GetMisses() const { return m_nMisses; }
+};
@@ -1896,6 +1896,10 @@ HRESULT CMPCVideoDecFilter::InitDecoder(const CMediaType* pmt)
 	const BOOL bMediaTypeChanged = (m_pCurrentMediaType != *pmt);
 	const BOOL bReinit = (m_pAVCtx != nullptr);
 
+	if (bMediaTypeChanged) {
+		m_FrameRing.Clear();
+	}
+
 	int64_t x264_build = -1;
 	if (m_CodecId == AV_CODEC_ID_H264 && bReinit && !bMediaTypeChanged) {
 		int64_t val = -1;
@@ -2980,6 +2984,10 @@ HRESULT CMPCVideoDecFilter::NewSegment(REFERENCE_TIME rtStart, REFERENCE_TIME rt
 
 	m_rtLastStop  = 0;
 
+	m_llSeekStart = GetPerfCounter();
+	m_nPrerollPackets = 0;
+	m_rtRingDelivered = INVALID_TIME;
+
 	if (m_bReorderBFrame) {
 		m_nBFramePos = 0;
 		m_tBFrameDelay[0].rtStart = m_tBFrameDelay[0].rtStop = INVALID_TIME;
@@ -2999,7 +3007,14 @@ HRESULT CMPCVideoDecFilter::NewSegment(REFERENCE_TIME rtStart, REFERENCE_TIME rt
 		}
 	}
 
-	return __super::NewSegment(rtStart, rtStop, dRate);
+	HRESULT hr = __super::NewSegment(rtStart, rtStop, dRate);
+
+	// a frame step back usually seeks to a frame from the ring
+	if (SUCCEEDED(hr) && IsFrameRingActive()) {
+		DeliverFromRing(rtStart);
+	}
+
+	return hr;
 }
 
 HRESULT CMPCVideoDecFilter::EndOfStream()
@@ -3287,6 +3302,88 @@ HRESULT CMPCVideoDecFilter::FillAVPacket(AVPacket *avpkt, const BYTE *buffer, in
 	return S_OK;
 }
 
+void CMPCVideoDecFilter::SetPrerollDiscard(const AVPacket* avpkt, const BOOL bPreroll)
+{
+	// thumbnail extraction needs only the keyframes
+	AVDiscard skip_frame = m_bKeyFramesOnly ? AVDISCARD_NONKEY : (AVDiscard)m_nDiscardMode;
+
+	// frames before the seek target are decoded only as references for the following frames,
+	// so non-reference frames there are not decoded at all
+	if (m_llSeekStart && (bPreroll || (avpkt->pts != INVALID_TIME && avpkt->pts < 0))) {
+		m_nPrerollPackets++;
+
+		// with reordered B-frame timings the packet time is not the time of its frame,
+		// and the frame ring needs all preroll frames for the next steps back
+		if (m_bSkipPrerollNonRef && !m_bReorderBFrame && !IsFrameRingActive()) {
+			switch (m_CodecId) {
+				case AV_CODEC_ID_H264:
+				case AV_CODEC_ID_HEVC:
+				case AV_CODEC_ID_MPEG2VIDEO:
+				case AV_CODEC_ID_VC1:
+				case AV_CODEC_ID_WMV3:
+					skip_frame = std::max(skip_frame, AVDISCARD_NONREF);
+					break;
+			}
+		}
+	}
+
+	m_pAVCtx->skip_frame = skip_frame;
+}
+
+void CMPCVideoDecFilter::FrameDelivered()
+{
+	if (m_llSeekStart) {
+		m_rtSeekLatency = GetPerfCounter() - m_llSeekStart;
+		m_llSeekStart = 0;
+		DLog(L"CMPCVideoDecFilter::FrameDelivered() : first frame after the new segment in %.1f ms, %u preroll packets",
+			 m_rtSeekLatency / 10000.0, m_nPrerollPackets);
+	}
+}
+
+bool CMPCVideoDecFilter::IsFrameRingActive()
+{
+	// the frames are needed only for stepping back, which seeks while paused
+	return m_FrameRing.IsEnabled() && m_State == State_Paused;
+}
+
+void CMPCVideoDecFilter::DeliverFromRing(const REFERENCE_TIME rtSegmentStart)
+{
+	const auto pFrame = m_FrameRing.Find(rtSegmentStart, GetFrameDuration());
+	if (!pFrame || m_bSendMediaType) {
+		return;
+	}
+
+	CComPtr<IMediaSample> pOut;
+	if (FAILED(m_pOutput->GetDeliveryBuffer(&pOut, nullptr, nullptr, 0))) {
+		return;
+	}
+
+	AM_MEDIA_TYPE* pmt;
+	if (SUCCEEDED(pOut->GetMediaType(&pmt)) && pmt) {
+		CMediaType mt = *pmt;
+		m_pOutput->SetMediaType(&mt);
+		DeleteMediaType(pmt);
+	}
+
+	if (!m_FrameRing.Copy(*pFrame, pOut, m_pOutput->CurrentMediaType())) {
+		// the renderer changed the format
+		m_FrameRing.Clear();
+		return;
+	}
+
+	REFERENCE_TIME rtStart = pFrame->rtStart - rtSegmentStart;
+	REFERENCE_TIME rtStop  = pFrame->rtStop - rtSegmentStart;
+	pOut->SetTime(&rtStart, &rtStop);
+	pOut->SetMediaTime(nullptr, nullptr);
+	pOut->SetSyncPoint(TRUE);
+
+	if (SUCCEEDED(m_pOutput->Deliver(pOut))) {
+		// the same frame will be decoded again, it is dropped
+		m_rtRingDelivered = rtStart;
+		FrameDelivered();
+	}
+}
+
 HRESULT CMPCVideoDecFilter::DecodeInternal(AVPacket *avpkt, REFERENCE_TIME rtStartIn, REFERENCE_TIME rtStopIn, BOOL bPreroll/* = FALSE*/)
 {
 #define CLEAR_AND_CONTINUE { av_frame_unref(m_pFrame); av_frame_free(&hw_frame); continue; }
@@ -3314,6 +3411,8 @@ HRESULT CMPCVideoDecFilter::DecodeInternal(AVPacket *avpkt, REFERENCE_TIME rtSta
 			uint8_t* pal = av_packet_new_side_data(avpkt, AV_PKT_DATA_PALETTE, AVPALETTE_SIZE);
 			memcpy(pal, m_Palette, AVPALETTE_SIZE);
 		}
+
+		SetPrerollDiscard(avpkt, bPreroll);
 	}
 
 	int ret = avcodec_send_packet(m_pAVCtx, avpkt);
@@ -3469,7 +3568,9 @@ HRESULT CMPCVideoDecFilter::DecodeInternal(AVPacket *avpkt, REFERENCE_TIME rtSta
 		bool bSampleTime = !(m_CodecId == AV_CODEC_ID_MJPEG && rtStartIn == INVALID_TIME);
 		UpdateFrameTime(rtStartIn, rtStopIn);
 
-		if (bPreroll || rtStartIn < 0) {
+		const bool bSkipFrame = bPreroll || rtStartIn < 0
+			|| (m_rtRingDelivered != INVALID_TIME && rtStartIn < m_rtRingDelivered + GetFrameDuration() / 2);
+		if (bSkipFrame && !IsFrameRingActive()) {
 			CLEAR_AND_CONTINUE;
 		}
 
@@ -3635,15 +3736,35 @@ HRESULT CMPCVideoDecFilter::DecodeInternal(AVPacket *avpkt, REFERENCE_TIME rtSta
 			}
 		}
 
+		SetTypeSpecificFlags(pOut);
+		AddFrameSideData(pOut, m_pFrame);
+
+		// the flags and the side data are kept in the ring with the frame
+		if (IsFrameRingActive()) {
+			if (rtStartIn != INVALID_TIME) {
+				const REFERENCE_TIME rtSegmentStart = m_pInput->CurrentStartTime();
+				m_FrameRing.Add(pOut, m_pOutput->CurrentMediaType(), rtSegmentStart + rtStartIn, rtSegmentStart + rtStopIn);
+			}
+
+			if (bSkipFrame) {
+				// the format change goes with the next delivered sample
+				AM_MEDIA_TYPE* pmt;
+				if (SUCCEEDED(pOut->GetMediaType(&pmt)) && pmt) {
+					DeleteMediaType(pmt);
+					m_bSendMediaType = true;
+				}
+				CLEAR_AND_CONTINUE;
+			}
+			m_rtRingDelivered = INVALID_TIME;
+		}
+
 		if (bSampleTime) {
 			pOut->SetTime(&rtStartIn, &rtStopIn);
 		}
 		pOut->SetMediaTime(nullptr, nullptr);
-		SetTypeSpecificFlags(pOut);
-
-		AddFrameSideData(pOut, m_pFrame);
 
 		hr = m_pOutput->Deliver(pOut);
+		FrameDelivered();
 
 		av_frame_unref(m_pFrame);
 		av_frame_free(&hw_frame);
@@ -4678,6 +4799,12 @@ STDMETHODIMP CMPCVideoDecFilter::GetInt(LPCSTR field, int* value)
 		return S_OK;
 	}
 
+	if (!strcmp(field, "frame_ring_size")) {
+		// memory limit in megabytes, 0 - disabled
+		*value = (int)(m_FrameRing.GetMaxSize() / MEGABYTE);
+		return S_OK;
+	}
+
 	return E_INVALIDARG;
 }
 
@@ -4693,6 +4820,26 @@ STDMETHODIMP CMPCVideoDecFilter::GetInt64(LPCSTR field, __int64 *value)
 		return S_OK;
 	}
 
+	if (!strcmp(field, "seek_latency")) {
+		*value = m_rtSeekLatency;
+		return S_OK;
+	}
+
+	if (!strcmp(field, "frame_ring_hits")) {
+		*value = m_FrameRing.GetHits();
+		return S_OK;
+	}
+
+	if (!strcmp(field, "frame_ring_misses")) {
+		*value = m_FrameRing.GetMisses();
+		return S_OK;
+	}
+
+	if (!strcmp(field, "frame_ring_memory")) {
+		*value = m_FrameRing.GetSize();
+		return S_OK;
+	}
+
 	return E_INVALIDARG;
 }
 
@@ -4748,6 +4895,20 @@ STDMETHODIMP CMPCVideoDecFilter::SetBool(LPCSTR field, bool value)
 		return S_OK;
 	}
 
+	if (strcmp(field, "preroll_skip_nonref") == 0) {
+		CAutoLock cAutoLock(&m_csReceive);
+
+		m_bSkipPrerollNonRef = value;
+		return S_OK;
+	}
+
+	if (strcmp(field, "keyframes_only") == 0) {
+		CAutoLock cAutoLock(&m_csReceive);
+
+		m_bKeyFramesOnly = value;
+		return S_OK;
+	}
+
 	return E_INVALIDARG;
 }
 
@@ -4772,6 +4933,21 @@ STDMETHODIMP CMPCVideoDecFilter::SetInt(LPCSTR field, int value)
 		return S_OK;
 	}
 
+	if (strcmp(field, "frame_ring_size") == 0) {
+		// memory limit in megabytes, 0 - disabled
+		if (value < 0 || value > 4096) {
+			return E_INVALIDARG;
+		}
+
+		CAutoLock cAutoLock(&m_csReceive);
+
+		m_FrameRing.SetMaxSize((size_t)value * MEGABYTE);
+		if (!m_FrameRing.IsEnabled()) {
+			m_rtRingDelivered = INVALID_TIME;
+		}
+		return S_OK;
+	}
+
 	return E_INVALIDARG;
 }
 
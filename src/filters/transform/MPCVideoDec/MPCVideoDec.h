@@ -26,6 +26,7 @@
 #include "MPCVideoDecSettingsWnd.h"
 #include "./DXVADecoder/DXVA2Decoder.h"
 #include "FormatConverter.h"
+#include "DecodedFrameRing.h"
 #include "apps/mplayerc/FilterEnum.h"
 
 #include <IMediaSideData.h>
@@ -72,6 +73,8 @@ private:
 	bool									m_VideoFilters[VDEC_COUNT];
 
 	bool									m_bEnableHwDecoding  = true; // internal (not saved)
+	bool									m_bSkipPrerollNonRef = true; // internal (not saved)
+	bool									m_bKeyFramesOnly     = false; // internal (not saved)
 	bool									m_bDXVACompatible;
 	unsigned __int64						m_nActiveCodecs;
 	BOOL									m_bInterlaced;
@@ -142,6 +145,13 @@ private:
 
 	REFERENCE_TIME							m_rtStartCache;
 
+	LONGLONG								m_llSeekStart     = 0; // GetPerfCounter() on a new segment, 0 - a frame was delivered after it
+	unsigned								m_nPrerollPackets = 0;
+	REFERENCE_TIME							m_rtSeekLatency   = 0; // time from the last new segment to the first delivered frame
+
+	CDecodedFrameRing						m_FrameRing;
+	REFERENCE_TIME							m_rtRingDelivered = INVALID_TIME; // time of the frame delivered from the ring after the new segment
+
 	DWORD									m_dwSYNC;
 	DWORD									m_dwSYNC2;
 
@@ -209,6 +219,9 @@ private:
 	void			BuildOutputFormat();
 
 	HRESULT			FillAVPacket(AVPacket *avpkt, const BYTE *buffer, int buflen);
+	void			SetPrerollDiscard(const AVPacket* avpkt, const BOOL bPreroll);
+	bool			IsFrameRingActive();
+	void			DeliverFromRing(const REFERENCE_TIME rtSegmentStart);
 	HRESULT			DecodeInternal(AVPacket *avpkt, REFERENCE_TIME rtStartIn, REFERENCE_TIME rtStopIn, BOOL bPreroll = FALSE);
 	HRESULT			ParseInternal(const BYTE *buffer, int buflen, REFERENCE_TIME rtStartIn, REFERENCE_TIME rtStopIn, BOOL bPreroll);
 	HRESULT			Decode(const BYTE *buffer, int buflen, REFERENCE_TIME rtStartIn, REFERENCE_TIME rtStopIn, BOOL bSyncPoint = FALSE, BOOL bPreroll = FALSE);
@@ -245,6 +258,7 @@ public:
 	void			UpdateFrameTime(REFERENCE_TIME& rtStart, REFERENCE_TIME& rtStop);
 	void			GetFrameTimeStamp(AVFrame* pFrame, REFERENCE_TIME& rtStart, REFERENCE_TIME& rtStop);
 	bool			AddFrameSideData(IMediaSample* pSample, AVFrame* pFrame);
+	void			FrameDelivered();
 
 	// === Overriden DirectShow functions
 	HRESULT			SetMediaType(PIN_DIRECTION direction, const CMediaType *pmt);
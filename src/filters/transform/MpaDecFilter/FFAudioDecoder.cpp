@@ -544,9 +544,13 @@ HRESULT CFFAudioDecoder::SendData(BYTE* p, int size, int* out_size)
 	return hr;
 }
 
-HRESULT CFFAudioDecoder::ReceiveData(std::vector<BYTE>& BuffOut, SampleFormat& samplefmt, REFERENCE_TIME& rtStart)
+HRESULT CFFAudioDecoder::ReceiveData(std::vector<BYTE>& BuffOut, SampleFormat& samplefmt, REFERENCE_TIME& rtStart, planar_float_t* pPlanar/* = nullptr*/)
 {
 	HRESULT hr = E_FAIL;
+	if (pPlanar) {
+		pPlanar->samples = 0;
+	}
+
 	const int ret = avcodec_receive_frame(m_pAVCtx, m_pFrame);
 	if (m_pAVCtx->ch_layout.nb_channels > 8 && !m_bNeedMix) {
 		// sometimes avcodec_receive_frame() cannot identify the garbage and produces incorrect data.
@@ -560,6 +564,19 @@ HRESULT CFFAudioDecoder::ReceiveData(std::vector<BYTE>& BuffOut, SampleFormat& s
 		if (nSamples) {
 			const WORD nChannels = m_pAVCtx->ch_layout.nb_channels;
 			samplefmt = (SampleFormat)m_pAVCtx->sample_fmt;
+
+			if (pPlanar && !m_bNeedMix && m_pAVCtx->sample_fmt == AV_SAMPLE_FMT_FLTP) {
+				// give out the frame planes without copying them,
+				// avcodec_receive_frame() releases the frame on the next call
+				pPlanar->planes.resize(nChannels);
+				for (int ch = 0; ch < nChannels; ++ch) {
+					pPlanar->planes[ch] = (const float*)m_pFrame->extended_data[ch];
+				}
+				pPlanar->samples = (int)nSamples;
+				BuffOut.clear();
+				return S_OK;
+			}
+
 			const size_t monosize = nSamples * av_get_bytes_per_sample(m_pAVCtx->sample_fmt);
 
 			auto* pBuffOut = &BuffOut;
@@ -35,6 +35,13 @@ const char* GetCodecDescriptorName(enum AVCodecID codec_id);
 
 class CMpaDecFilter;
 
+// planes of a float planar frame that still belong to the decoder
+
+struct planar_float_t {
+	std::vector<const float*> planes;
+	int samples = 0;
+};
+
 // CFFAudioDecoder
 
 class CFFAudioDecoder
@@ -77,7 +84,7 @@ public:
 
 	HRESULT RealPrepare(BYTE* p, int buffsize, CPaddedBuffer& BuffOut);
 	HRESULT SendData(BYTE* p, int size, int* out_size = nullptr);
-	HRESULT ReceiveData(std::vector<BYTE>& BuffOut, SampleFormat& samplefmt, REFERENCE_TIME& rtStart);
+	HRESULT ReceiveData(std::vector<BYTE>& BuffOut, SampleFormat& samplefmt, REFERENCE_TIME& rtStart, planar_float_t* pPlanar = nullptr);
 	void    FlushBuffers();
 	void    StreamFinish();
 
@@ -790,19 +790,14 @@ HRESULT CMpaDecFilter::ProcessFFmpeg(enum AVCodecID nCodecId, BOOL bEOF/* = FALS
 		}
 	}
 
+	// reused for all frames of this call
+	std::vector<BYTE> output;
+	planar_float_t planar;
+
 	if (bEOF) {
 		hr = m_FFAudioDec.SendData(nullptr, 0);
 		if (hr == S_OK) {
-			std::vector<BYTE> output;
-			SampleFormat samplefmt = SAMPLE_FMT_NONE;
-
-			REFERENCE_TIME rtStart = INVALID_TIME;
-			while (S_OK == (hr = m_FFAudioDec.ReceiveData(output, samplefmt, rtStart))) {
-				if (output.size()) {
-					hr = Deliver(output.data(), output.size(), rtStart, samplefmt, m_FFAudioDec.GetSampleRate(), m_FFAudioDec.GetChannels(), m_FFAudioDec.GetChannelMask());
-					output.clear();
-				}
-			}
+			hr = ReceiveFFmpeg(output, planar);
 		}
 
 		return S_OK;
@@ -839,16 +834,7 @@ HRESULT CMpaDecFilter::ProcessFFmpeg(enum AVCodecID nCodecId, BOOL bEOF/* = FALS
 
 		hr = m_FFAudioDec.SendData(p, int(end - p), &out_size);
 		if (S_OK == hr) {
-			std::vector<BYTE> output;
-			SampleFormat samplefmt = SAMPLE_FMT_NONE;
-
-			REFERENCE_TIME rtStart = INVALID_TIME;
-			while (S_OK == (hr = m_FFAudioDec.ReceiveData(output, samplefmt, rtStart))) {
-				if (output.size()) {
-					hr = Deliver(output.data(), output.size(), rtStart, samplefmt, m_FFAudioDec.GetSampleRate(), m_FFAudioDec.GetChannels(), m_FFAudioDec.GetChannelMask());
-					output.clear();
-				}
-			}
+			hr = ReceiveFFmpeg(output, planar);
 		} else {
 			m_bResync = TRUE;
 			if (!out_size && hr == E_FAIL) {
@@ -870,6 +856,25 @@ HRESULT CMpaDecFilter::ProcessFFmpeg(enum AVCodecID nCodecId, BOOL bEOF/* = FALS
 	return S_OK;
 }
 
+HRESULT CMpaDecFilter::ReceiveFFmpeg(std::vector<BYTE>& output, planar_float_t& planar)
+{
+	HRESULT hr;
+	SampleFormat samplefmt = SAMPLE_FMT_NONE;
+
+	REFERENCE_TIME rtStart = INVALID_TIME;
+	while (S_OK == (hr = m_FFAudioDec.ReceiveData(output, samplefmt, rtStart, &planar))) {
+		if (planar.samples) {
+			const WORD nChannels = (WORD)planar.planes.size();
+			hr = Deliver(nullptr, planar.samples * nChannels * sizeof(float), rtStart, samplefmt, m_FFAudioDec.GetSampleRate(), nChannels, m_FFAudioDec.GetChannelMask(), planar.planes.data());
+		} else if (output.size()) {
+			hr = Deliver(output.data(), output.size(), rtStart, samplefmt, m_FFAudioDec.GetSampleRate(), m_FFAudioDec.GetChannels(), m_FFAudioDec.GetChannelMask());
+			output.clear();
+		}
+	}
+
+	return hr;
+}
+
 HRESULT CMpaDecFilter::ProcessAC3_SPDIF()
 {
 	HRESULT hr;
@@ -1798,7 +1803,7 @@ HRESULT CMpaDecFilter::GetDeliveryBuffer(IMediaSample** pSample, BYTE** pData)
 	return S_OK;
 }
 
-HRESULT CMpaDecFilter::Deliver(BYTE* pBuff, const size_t size, const REFERENCE_TIME rtStartInput, const SampleFormat sfmt, const DWORD nSamplesPerSec, const WORD nChannels, DWORD dwChannelMask/* = 0*/)
+HRESULT CMpaDecFilter::Deliver(BYTE* pBuff, const size_t size, const REFERENCE_TIME rtStartInput, const SampleFormat sfmt, const DWORD nSamplesPerSec, const WORD nChannels, DWORD dwChannelMask/* = 0*/, const float* const* planes/* = nullptr*/)
 {
 	if (m_bFlushing) {
 		return S_FALSE;
@@ -1811,7 +1816,21 @@ HRESULT CMpaDecFilter::Deliver(BYTE* pBuff, const size_t size, const REFERENCE_T
 
 	m_InternalSampleFormat = sfmt;
 
-	if (m_bBitstreamSupported[SPDIF] && GetSPDIF(ac3enc) && nChannels > 2) { // do not encode mono and stereo
+	const bool bAC3Encode = m_bBitstreamSupported[SPDIF] && GetSPDIF(ac3enc) && nChannels > 2; // do not encode mono and stereo
+	const MPCSampleFormat out_mpcsf = SelectOutputFormat(SamplefmtToMPC[sfmt]);
+
+	if (planes && (bAC3Encode || out_mpcsf != SF_FLOAT)) {
+		// only float output is interleaved straight from the planes
+		const size_t monosize = size / nChannels;
+		m_planarbuff.resize(size);
+		for (WORD ch = 0; ch < nChannels; ch++) {
+			memcpy(m_planarbuff.data() + monosize * ch, planes[ch], monosize);
+		}
+		pBuff = m_planarbuff.data();
+		planes = nullptr;
+	}
+
+	if (bAC3Encode) {
 		return AC3Encode(pBuff, size, rtStartInput, sfmt, nSamplesPerSec, nChannels, dwChannelMask);
 	}
 
@@ -1840,7 +1859,6 @@ HRESULT CMpaDecFilter::Deliver(BYTE* pBuff, const size_t size, const REFERENCE_T
 		return S_OK;
 	}
 
-	MPCSampleFormat out_mpcsf = SelectOutputFormat(SamplefmtToMPC[sfmt]);
 	const SampleFormat out_sf = MPCtoSamplefmt[out_mpcsf];
 
 	BYTE*  pDataIn  = pBuff;
@@ -1890,7 +1908,11 @@ HRESULT CMpaDecFilter::Deliver(BYTE* pBuff, const size_t size, const REFERENCE_T
 			convert_to_int32(sfmt, nChannels, nSamples, pDataIn, (int32_t*)pDataOut);
 			break;
 		case SF_FLOAT:
-			convert_to_float(sfmt, nChannels, nSamples, pDataIn, (float*)pDataOut);
+			if (planes) {
+				interleave_planar_float((float*)pDataOut, planes, nChannels, nSamples);
+			} else {
+				convert_to_float(sfmt, nChannels, nSamples, pDataIn, (float*)pDataOut);
+			}
 			break;
 	}
 
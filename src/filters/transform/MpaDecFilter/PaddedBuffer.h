@@ -1,5 +1,5 @@
 /*
- * (C) 2014-2022 see Authors.txt
+ * (C) 2014-2023 see Authors.txt
  *
  * This file is part of MPC-BE.
  *
@@ -23,11 +23,23 @@
 #include <basestruct.h>
 
 // A dynamic buffer with a guaranteed padded block at the end and no member initialization.
+// RemoveHead() only moves the start offset. The unused space at the front is reclaimed
+// by Resize()/Append() once it is not smaller than the data, so every byte is moved
+// at most once on average.
 class CPaddedBuffer
 {
 private:
 	std::vector<NoInitByte> m_data;
 	const size_t m_padsize;
+	size_t m_head = 0;
+
+	void Compact()
+	{
+		const size_t size = Size();
+		memmove(m_data.data(), m_data.data() + m_head, size + m_padsize);
+		m_data.resize(size + m_padsize);
+		m_head = 0;
+	}
 
 public:
 	CPaddedBuffer(size_t padsize)
@@ -37,19 +49,23 @@ public:
 
 	uint8_t* Data()
 	{
-		return (uint8_t*)m_data.data(); // don't use "&front().value" here, because it does not work for an empty array
+		return (uint8_t*)m_data.data() + m_head; // don't use "&front().value" here, because it does not work for an empty array
 	}
 
 	size_t Size()
 	{
-		const size_t count = m_data.size();
+		const size_t count = m_data.size() - m_head;
 		return (count > m_padsize) ? count - m_padsize : 0;
 	}
 
 	bool Resize(const size_t count)
 	{
+		if (m_head && (m_head >= Size() || m_head + count + m_padsize > m_data.capacity())) {
+			Compact();
+		}
+
 		try {
-			m_data.resize(count + m_padsize);
+			m_data.resize(m_head + count + m_padsize);
 		}
 		catch (...) {
 			return false;
@@ -61,6 +77,7 @@ public:
 	void Clear()
 	{
 		m_data.clear();
+		m_head = 0;
 	}
 
 	bool Append(uint8_t* p, const size_t count)
@@ -81,10 +98,7 @@ public:
 		if (count >= oldsize) {
 			Clear();
 		} else {
-			const size_t newsize = oldsize - count;
-			memmove(Data(), Data() + count, newsize);
-			memset(Data() + newsize, 0, m_padsize);
-			m_data.resize(newsize + m_padsize);
+			m_head += count;
 		}
 	}
 };